@@ -34,7 +34,9 @@ public class KantanDocGen : ModuleRules
 				"XmlParser",
 				"UMG",
 				"Projects",
-                "ImageWriteQueue"
+                "ImageWriteQueue",
+				"RenderCore",
+				"RHI"
             }
         );
 	}
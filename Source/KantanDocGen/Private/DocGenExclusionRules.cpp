@@ -0,0 +1,238 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#include "DocGenExclusionRules.h"
+#include "DocGenSettings.h"
+#include "KantanDocGenLog.h"
+#include "AssetData.h"
+#include "UObject/Class.h"
+#include "UObject/Package.h"
+#include "UObject/MetaData.h"
+#include "Engine/BlueprintGeneratedClass.h"
+
+
+FDocGenExclusionRules::FDocGenExclusionRules(FKantanDocGenSettings const& Settings)
+{
+	for(auto const& Name : Settings.ExcludedClasses)
+	{
+		AddRule(Name.ToString());
+	}
+
+	for(auto const& Rule : Settings.ExclusionRules)
+	{
+		AddRule(Rule);
+	}
+}
+
+void FDocGenExclusionRules::AddRule(FString const& Rule)
+{
+	FString Pattern = Rule.TrimStartAndEnd();
+
+	bool const bInclude = Pattern.StartsWith(TEXT("+"));
+	if(bInclude || Pattern.StartsWith(TEXT("-")))
+	{
+		Pattern.RemoveAt(0, 1, false);
+	}
+
+	FRuleSet* RuleSet = &ClassNames;
+	FString Kind, Value;
+	if(Pattern.Split(TEXT(":"), &Kind, &Value))
+	{
+		if(Kind == TEXT("Module"))
+		{
+			RuleSet = &Modules;
+		}
+		else if(Kind == TEXT("Category"))
+		{
+			RuleSet = &CategoryPrefixes;
+			// Categories are matched on prefix
+			Value += TEXT("*");
+		}
+		else if(Kind == TEXT("Meta"))
+		{
+			RuleSet = &MetaKeys;
+		}
+		else if(Kind == TEXT("Class"))
+		{
+			RuleSet = &ClassNames;
+		}
+		else
+		{
+			UE_LOG(LogKantanDocGen, Warning, TEXT("Unknown exclusion rule type '%s' in rule '%s', ignoring."), *Kind, *Rule);
+			return;
+		}
+
+		Pattern = Value.TrimStartAndEnd();
+	}
+
+	if(Pattern.IsEmpty())
+	{
+		return;
+	}
+
+	(bInclude ? RuleSet->Included : RuleSet->Excluded).Add(Pattern);
+}
+
+bool FDocGenExclusionRules::IsEmpty() const
+{
+	return ClassNames.Excluded.IsEmpty()
+		&& Modules.Excluded.IsEmpty()
+		&& CategoryPrefixes.Excluded.IsEmpty()
+		&& MetaKeys.Excluded.IsEmpty();
+}
+
+bool FDocGenExclusionRules::IsClassExcluded(UClass* Class) const
+{
+	if(Class == nullptr)
+	{
+		return false;
+	}
+
+	if(auto Decision = ClassDecisions.Find(Class))
+	{
+		return *Decision;
+	}
+
+	// Blueprint classes are matched on the blueprint name, as well as the generated class name
+	TArray< FString > ClassNamesToMatch;
+	ClassNamesToMatch.Add(Class->GetName());
+	if(Class->ClassGeneratedBy)
+	{
+		ClassNamesToMatch.Add(Class->ClassGeneratedBy->GetName());
+	}
+
+	bool const bExcluded = IsExcluded(ClassNamesToMatch, GetModuleName(Class->GetOutermost()->GetName()));
+
+	ClassDecisions.Add(Class, bExcluded);
+	return bExcluded;
+}
+
+bool FDocGenExclusionRules::IsBlueprintAssetExcluded(FAssetData const& AssetData) const
+{
+	FString const AssetName = AssetData.AssetName.ToString();
+	return IsExcluded({ AssetName, AssetName + TEXT("_C") }, GetModuleName(AssetData.PackageName.ToString()));
+}
+
+bool FDocGenExclusionRules::IsFunctionExcluded(UFunction* Func) const
+{
+	if(CategoryPrefixes.Excluded.IsEmpty() && MetaKeys.Excluded.IsEmpty())
+	{
+		return false;
+	}
+
+	static const FName CategoryMeta(TEXT("Category"));
+	FString const& Category = Func->GetMetaData(CategoryMeta);
+	TArray< FString > MetaKeyNames;
+	if(auto MetaMap = UMetaData::GetMapForObject(Func))
+	{
+		for(auto const& Entry : *MetaMap)
+		{
+			MetaKeyNames.Add(Entry.Key.ToString());
+		}
+	}
+
+	// Any inclusion overrides exclusions of either kind
+	if(CategoryPrefixes.Included.Matches(Category) || MetaKeyNames.ContainsByPredicate([this](FString const& Key) { return MetaKeys.Included.Matches(Key); }))
+	{
+		return false;
+	}
+
+	return CategoryPrefixes.Excluded.Matches(Category)
+		|| MetaKeyNames.ContainsByPredicate([this](FString const& Key) { return MetaKeys.Excluded.Matches(Key); });
+}
+
+bool FDocGenExclusionRules::IsExcluded(TArray< FString > const& ClassNamesToMatch, FString const& ModuleName) const
+{
+	// Any inclusion overrides exclusions of either kind, so '+MyActor' wins over 'Module:MyModule'
+	for(auto const& ClassName : ClassNamesToMatch)
+	{
+		if(ClassNames.Included.Matches(ClassName))
+		{
+			return false;
+		}
+	}
+	if(Modules.Included.Matches(ModuleName))
+	{
+		return false;
+	}
+
+	for(auto const& ClassName : ClassNamesToMatch)
+	{
+		if(ClassNames.Excluded.Matches(ClassName))
+		{
+			return true;
+		}
+	}
+	return Modules.Excluded.Matches(ModuleName);
+}
+
+FString FDocGenExclusionRules::GetModuleName(FString const& PackageName)
+{
+	// '/Script/<Module>' for native classes, '/<Root>/...' for content
+	FString Path = PackageName;
+	if(Path.StartsWith(TEXT("/Script/")))
+	{
+		Path = Path.RightChop(8);
+	}
+	else
+	{
+		Path.RemoveFromStart(TEXT("/"));
+	}
+
+	int32 SlashIdx = INDEX_NONE;
+	if(Path.FindChar(TEXT('/'), SlashIdx))
+	{
+		Path = Path.Left(SlashIdx);
+	}
+	return Path;
+}
+
+void FDocGenExclusionRules::FPatternSet::Add(FString const& Pattern)
+{
+	int32 WildcardIdx = INDEX_NONE;
+	bool const bHasWildcard = Pattern.FindChar(TEXT('*'), WildcardIdx) || Pattern.FindChar(TEXT('?'), WildcardIdx);
+	if(!bHasWildcard)
+	{
+		Exact.Add(Pattern);
+	}
+	else if(WildcardIdx == Pattern.Len() - 1 && Pattern[WildcardIdx] == TEXT('*') && !Pattern.Contains(TEXT("?")))
+	{
+		// Trailing '*' only, so a plain prefix
+		Prefixes.Add(Pattern.LeftChop(1));
+	}
+	else
+	{
+		Wildcards.Add(Pattern);
+	}
+}
+
+bool FDocGenExclusionRules::FPatternSet::Matches(FString const& Value) const
+{
+	// TSet< FString > hashes case insensitively, consistent with the other matches
+	if(Exact.Contains(Value))
+	{
+		return true;
+	}
+
+	for(auto const& Prefix : Prefixes)
+	{
+		if(Value.StartsWith(Prefix))
+		{
+			return true;
+		}
+	}
+
+	for(auto const& Wildcard : Wildcards)
+	{
+		if(Value.MatchesWildcard(Wildcard))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
@@ -0,0 +1,78 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+struct FKantanDocGenSettings;
+struct FAssetData;
+class UClass;
+class UFunction;
+
+/*
+Compiled form of the exclusion settings, consulted by the enumerators and spawner filter before anything is loaded or spawned.
+
+Each rule is a class name or wildcard pattern, or one of:
+	Module:<Name>		Native module, or content root such as 'Game' for blueprints
+	Category:<Prefix>	Functions whose category starts with the prefix
+	Meta:<Key>			Functions with the metadata key
+A rule with a leading '+' is an inclusion, overriding any exclusion which matches the same thing.
+
+Class decisions are memoized, so this is game thread only.
+*/
+class FDocGenExclusionRules
+{
+public:
+	FDocGenExclusionRules()
+	{}
+	explicit FDocGenExclusionRules(FKantanDocGenSettings const& Settings);
+
+public:
+	void AddRule(FString const& Rule);
+	/** True if nothing can be excluded, inclusions having nothing to override. */
+	bool IsEmpty() const;
+
+	bool IsClassExcluded(UClass* Class) const;
+	/** Judged from the asset's registry data only, without loading it. */
+	bool IsBlueprintAssetExcluded(FAssetData const& AssetData) const;
+	bool IsFunctionExcluded(UFunction* Func) const;
+
+protected:
+	/* Set of patterns of one kind, with exact names and simple prefixes separated out from general wildcards. */
+	struct FPatternSet
+	{
+		TSet< FString > Exact;
+		TArray< FString > Prefixes;
+		TArray< FString > Wildcards;
+
+		void Add(FString const& Pattern);
+		bool Matches(FString const& Value) const;
+		bool IsEmpty() const { return Exact.Num() == 0 && Prefixes.Num() == 0 && Wildcards.Num() == 0; }
+	};
+
+	/* Exclusion and inclusion patterns of one kind. */
+	struct FRuleSet
+	{
+		FPatternSet Excluded;
+		FPatternSet Included;
+	};
+
+	/** Excluded if any name or the module matches an exclusion, and none of them match an inclusion. */
+	bool IsExcluded(TArray< FString > const& ClassNamesToMatch, FString const& ModuleName) const;
+	static FString GetModuleName(FString const& PackageName);
+
+protected:
+	FRuleSet ClassNames;
+	FRuleSet Modules;
+	FRuleSet CategoryPrefixes;
+	FRuleSet MetaKeys;
+
+	// Weak, since blueprint classes may be collected during the run and their addresses reused
+	mutable TMap< TWeakObjectPtr< UClass >, bool > ClassDecisions;
+};
+
@@ -0,0 +1,62 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#include "DocGenImageCache.h"
+#include "KantanDocGenLog.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/Guid.h"
+
+
+FString FDocGenImageCache::GetDefaultDirectory()
+{
+	return FPaths::ProjectIntermediateDir() / TEXT("KantanDocGenCache") / TEXT("Images");
+}
+
+FString FDocGenImageCache::GetCachedImagePath(FString const& Key) const
+{
+	return CacheDir / (Key + TEXT(".png"));
+}
+
+bool FDocGenImageCache::Contains(FString const& Key) const
+{
+	return IFileManager::Get().FileExists(*GetCachedImagePath(Key));
+}
+
+bool FDocGenImageCache::Retrieve(FString const& Key, FString const& DestPath) const
+{
+	if(IFileManager::Get().Copy(*DestPath, *GetCachedImagePath(Key), true, true) != COPY_OK)
+	{
+		UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to copy cached node image '%s' to '%s'."), *Key, *DestPath);
+		return false;
+	}
+
+	return true;
+}
+
+bool FDocGenImageCache::Store(FString const& Key, FString const& SourcePath) const
+{
+	auto& FileManager = IFileManager::Get();
+	auto const CachedPath = GetCachedImagePath(Key);
+	if(FileManager.FileExists(*CachedPath))
+	{
+		return true;
+	}
+
+	// Copy to a unique temporary first so that a partially written file is never visible under the key,
+	// even with multiple doc sets being generated at once.
+	auto const TempPath = CachedPath + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+	if(FileManager.Copy(*TempPath, *SourcePath, true, true) != COPY_OK
+		|| !FileManager.Move(*CachedPath, *TempPath, true, true))
+	{
+		FileManager.Delete(*TempPath, false, false, true);
+		UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to add node image '%s' to the image cache."), *SourcePath);
+		return false;
+	}
+
+	return true;
+}
+
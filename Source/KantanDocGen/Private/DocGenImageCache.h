@@ -0,0 +1,37 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/*
+Content addressed store of node images, keyed on a hash of everything affecting a node's appearance.
+Shared between all doc sets in the project, so identical nodes are only ever rendered once.
+Stateless aside from the cache location, so safe to use concurrently from any thread.
+*/
+class FDocGenImageCache
+{
+public:
+	FDocGenImageCache(FString const& InCacheDir = GetDefaultDirectory()):
+		CacheDir(InCacheDir)
+	{}
+
+public:
+	static FString GetDefaultDirectory();
+
+	FString GetCachedImagePath(FString const& Key) const;
+	bool Contains(FString const& Key) const;
+	/** Copies the cached image for Key to DestPath. */
+	bool Retrieve(FString const& Key, FString const& DestPath) const;
+	/** Adds the image at SourcePath to the cache under Key, if not already present. */
+	bool Store(FString const& Key, FString const& SourcePath) const;
+
+protected:
+	FString CacheDir;
+};
+
@@ -0,0 +1,116 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#include "DocGenManifest.h"
+#include "DocGenSettings.h"
+#include "NodeDocsGenerator.h"
+#include "KantanDocGenLog.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Crc.h"
+
+
+// Bump whenever the format of generated artifacts changes, to force a full regeneration
+static const int32 ManifestVersion = 1;
+static const TCHAR* const ManifestHeader = TEXT("KantanDocGenManifest");
+
+
+bool FDocGenManifest::Load(FString const& Path, uint32 InSettingsHash)
+{
+	SettingsHash = InSettingsHash;
+	PreviousRun.Empty();
+	CurrentRun.Empty();
+
+	TArray< FString > Lines;
+	if(!FFileHelper::LoadFileToStringArray(Lines, *Path) || Lines.Num() == 0)
+	{
+		return false;
+	}
+
+	TArray< FString > Header;
+	Lines[0].ParseIntoArray(Header, TEXT("\t"));
+	if(Header.Num() != 3
+		|| Header[0] != ManifestHeader
+		|| FCString::Atoi(*Header[1]) != ManifestVersion
+		|| FCString::Strtoui64(*Header[2], nullptr, 10) != SettingsHash)
+	{
+		UE_LOG(LogKantanDocGen, Log, TEXT("Previous doc manifest is out of date, all nodes will be regenerated."));
+		return false;
+	}
+
+	for(int32 Idx = 1; Idx < Lines.Num(); ++Idx)
+	{
+		FString Key, Signature;
+		if(Lines[Idx].Split(TEXT("\t"), &Key, &Signature, ESearchCase::CaseSensitive, ESearchDir::FromEnd))
+		{
+			PreviousRun.Add(Key, (uint32)FCString::Strtoui64(*Signature, nullptr, 10));
+		}
+	}
+
+	UE_LOG(LogKantanDocGen, Log, TEXT("Loaded doc manifest with %i nodes from previous run."), PreviousRun.Num());
+	return true;
+}
+
+bool FDocGenManifest::Save(FString const& Path) const
+{
+	FString Contents = FString::Printf(TEXT("%s\t%i\t%u\n"), ManifestHeader, ManifestVersion, SettingsHash);
+	for(auto const& Entry : CurrentRun)
+	{
+		Contents += FString::Printf(TEXT("%s\t%u\n"), *Entry.Key, Entry.Value);
+	}
+
+	if(!FFileHelper::SaveStringToFile(Contents, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to save doc manifest to '%s'."), *Path);
+		return false;
+	}
+
+	return true;
+}
+
+bool FDocGenManifest::Update(FString const& NodeKey, uint32 Signature)
+{
+	CurrentRun.Add(NodeKey, Signature);
+
+	auto Previous = PreviousRun.Find(NodeKey);
+	return Previous && *Previous == Signature;
+}
+
+TArray< FString > FDocGenManifest::GetStaleNodes() const
+{
+	TArray< FString > Stale;
+	for(auto const& Entry : PreviousRun)
+	{
+		if(!CurrentRun.Contains(Entry.Key))
+		{
+			Stale.Add(Entry.Key);
+		}
+	}
+	return Stale;
+}
+
+FString FDocGenManifest::MakeNodeKey(FString const& ClassId, FString const& NodeId)
+{
+	return ClassId / NodeId;
+}
+
+bool FDocGenManifest::SplitNodeKey(FString const& NodeKey, FString& OutClassId, FString& OutNodeId)
+{
+	return NodeKey.Split(TEXT("/"), &OutClassId, &OutNodeId);
+}
+
+uint32 FDocGenManifest::HashSettings(FKantanDocGenSettings const& Settings)
+{
+	FString const SettingsString = FString::Printf(TEXT("%i|%s|%s|%i|%i"),
+		FNodeDocsGenerator::NodeArtifactVersion,
+		*Settings.DocumentationTitle,
+		Settings.BlueprintContextClass ? *Settings.BlueprintContextClass->GetPathName() : TEXT("None"),
+		Settings.bDirectHtmlOutput ? 1 : 0,
+		Settings.bGenerateImages ? 1 : 0
+	);
+
+	return FCrc::StrCrc32(*SettingsString);
+}
+
@@ -0,0 +1,47 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+struct FKantanDocGenSettings;
+
+/*
+Persisted record of a signature for every node documented in a run, keyed on '<ClassId>/<NodeId>'.
+Used for incremental generation, where nodes whose signature is unchanged since the previous run reuse the existing artifacts.
+Not thread safe, it's expected to be updated only from the game thread during node enumeration.
+*/
+class FDocGenManifest
+{
+public:
+	FDocGenManifest():
+		SettingsHash(0)
+	{}
+
+public:
+	/** Loads the manifest from a previous run. Returns false if there was none, or it was generated with different settings. */
+	bool Load(FString const& Path, uint32 InSettingsHash);
+	bool Save(FString const& Path) const;
+
+	/** Records the signature of a node in the current run, returns true if it matches that from the previous run. */
+	bool Update(FString const& NodeKey, uint32 Signature);
+	/** Keys of nodes documented in the previous run which were not seen in the current one. */
+	TArray< FString > GetStaleNodes() const;
+
+	static FString MakeNodeKey(FString const& ClassId, FString const& NodeId);
+	static bool SplitNodeKey(FString const& NodeKey, FString& OutClassId, FString& OutNodeId);
+
+	/** Hash of all settings which affect the generated artifacts of an individual node, along with the version of those artifacts. */
+	static uint32 HashSettings(FKantanDocGenSettings const& Settings);
+
+protected:
+	uint32 SettingsHash;
+	TMap< FString, uint32 > PreviousRun;
+	TMap< FString, uint32 > CurrentRun;
+};
+
@@ -15,6 +15,15 @@
 #include "DocGenSettings.generated.h"
 
 
+UENUM()
+enum class EKantanDocGenConverter: uint8
+{
+	/** Convert intermediate xml to html in process. */
+	Native,
+	/** Convert using the external KantanDocGen tool (Windows only). */
+	ExternalTool,
+};
+
 USTRUCT()
 struct FKantanDocGenSettings
 {
@@ -41,6 +50,13 @@ public:
 	UPROPERTY()//EditAnywhere, Category = "Class Search")
 	TArray< FName > ExcludedClasses;
 
+	/**
+	Rules for classes, blueprints and functions to leave out of the docs, checked before anything is loaded or spawned.
+	Class names or wildcard patterns, or prefixed with 'Module:', 'Category:' or 'Meta:'. A leading '+' overrides exclusions.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Class Search", AdvancedDisplay)
+	TArray< FString > ExclusionRules;
+
 	UPROPERTY(EditAnywhere, Category = "Output")
 	FDirectoryPath OutputDirectory;
 
@@ -50,11 +66,108 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Output")
 	bool bCleanOutputDirectory;
 
+	/**
+	How the intermediate xml docs are converted into html.
+	The native converter produces the same markup as the external tool, but files aren't byte identical since indentation and the page head differ.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Output", AdvancedDisplay)
+	EKantanDocGenConverter Converter;
+
+	/** Write html pages directly as nodes are documented, skipping the intermediate xml stage. Always uses the native converter. */
+	UPROPERTY(EditAnywhere, Category = "Output", AdvancedDisplay)
+	bool bDirectHtmlOutput;
+
+	/** Capture and include node images. Disabling produces text only docs, without requiring any rendering. */
+	UPROPERTY(EditAnywhere, Category = "Output", AdvancedDisplay)
+	bool bGenerateImages;
+
+	/** Only regenerate nodes which have changed since the previous run, reusing existing docs and images for the rest. */
+	UPROPERTY(EditAnywhere, Category = "Output", AdvancedDisplay)
+	bool bIncrementalGeneration;
+
+	/** Maximum number of nodes to spawn and capture in a single game thread dispatch. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay, Meta = (ClampMin = 1, UIMin = 1, UIMax = 256))
+	int32 NodeBatchSize;
+
+	/** Maximum number of captured nodes waiting on image encoding and doc serialization before capture is throttled. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay, Meta = (ClampMin = 1, UIMin = 1, UIMax = 1024))
+	int32 MaxNodesInFlight;
+
+	/** Maximum number of node images queued for encoding and writing at once. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay, Meta = (ClampMin = 1, UIMin = 1, UIMax = 1024))
+	int32 MaxPendingImageWrites;
+
+	/** Number of written class docs kept in memory, for nodes which arrive for a class after it has been written out. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay, Meta = (ClampMin = 0, UIMin = 0, UIMax = 1024))
+	int32 LateClassDocBufferSize;
+
+	/** Reuse node images rendered previously, by this or any other doc set in the project, for nodes which look identical. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay)
+	bool bUseImageCache;
+
+	/** Render each batch of nodes together into a shared render target, with a single readback per batch rather than per node. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay)
+	bool bAtlasCapture;
+
+	/** Width and height of the render target used for atlas capture. Nodes which don't fit are captured individually. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay, Meta = (EditCondition = "bAtlasCapture", ClampMin = 256, UIMin = 256, UIMax = 4096))
+	int32 AtlasSize;
+
+	/** Copy node images to staging textures on the GPU and map them once ready, rather than stalling the game thread per node. Ignored with the null RHI. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay)
+	bool bAsyncReadback;
+
+	/** Maximum number of node image readbacks in flight on the GPU at once. Capture waits on the oldest when the limit is reached. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay, Meta = (EditCondition = "bAsyncReadback", ClampMin = 1, UIMin = 1, UIMax = 16))
+	int32 ReadbackRingSize;
+
+	/**
+	Create node spawners directly from the classes and blueprints being documented, rather than from the blueprint action
+	database, so that small targeted runs don't pay for building actions for every class loaded in the editor.
+	Only function and event nodes are documented in this mode, node types which register their own actions are skipped.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay)
+	bool bScopedActionRefresh;
+
+	/** Number of upcoming blueprints under the content paths to load asynchronously ahead of being documented. 0 loads each synchronously when reached. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay, Meta = (ClampMin = 0, UIMin = 0, UIMax = 64))
+	int32 AssetPrefetchCount;
+
+	/** Resident memory, in MB, above which garbage is collected between source objects to release processed blueprints and nodes. 0 for no limit. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay, Meta = (ClampMin = 0, UIMin = 0))
+	int32 MemoryBudgetMB;
+
+	/** Number of nodes spawned into each temporary graph before it is replaced with a fresh one, checked between node batches. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay, Meta = (ClampMin = 1, UIMin = 1, UIMax = 4096))
+	int32 GraphRecycleInterval;
+
+	/** When images are disabled, document native function calls straight from reflection data, rather than spawning nodes. */
+	UPROPERTY(EditAnywhere, Category = "Performance", AdvancedDisplay)
+	bool bReflectionFastPath;
+
 public:
 	FKantanDocGenSettings()
 	{
 		BlueprintContextClass = AActor::StaticClass();
 		bCleanOutputDirectory = false;
+		Converter = EKantanDocGenConverter::Native;
+		bDirectHtmlOutput = false;
+		bGenerateImages = true;
+		bIncrementalGeneration = false;
+		NodeBatchSize = 16;
+		MaxNodesInFlight = 64;
+		MaxPendingImageWrites = 32;
+		LateClassDocBufferSize = 64;
+		bUseImageCache = false;
+		bAtlasCapture = false;
+		AtlasSize = 2048;
+		bAsyncReadback = false;
+		ReadbackRingSize = 4;
+		bScopedActionRefresh = false;
+		AssetPrefetchCount = 8;
+		MemoryBudgetMB = 0;
+		GraphRecycleInterval = 512;
+		bReflectionFastPath = false;
 	}
 
 	bool HasAnySources() const
@@ -0,0 +1,282 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#include "DocGenSpawnerIndex.h"
+#include "KantanDocGenLog.h"
+#include "BlueprintActionDatabase.h"
+#include "BlueprintNodeSpawner.h"
+#include "BlueprintFunctionNodeSpawner.h"
+#include "BlueprintVariableNodeSpawner.h"
+#include "BlueprintDelegateNodeSpawner.h"
+#include "BlueprintBoundNodeSpawner.h"
+#include "BlueprintComponentNodeSpawner.h"
+#include "BlueprintEventNodeSpawner.h"
+#include "K2Node.h"
+#include "K2Node_DynamicCast.h"
+#include "K2Node_Message.h"
+#include "Engine/Blueprint.h"
+#include "EdGraphSchema_K2.h"
+#include "UObject/UnrealType.h"
+#include "DocGenExclusionRules.h"
+
+
+FDocGenSpawnerIndex::~FDocGenSpawnerIndex()
+{
+	ReleaseScopedSpawners();
+}
+
+void FDocGenSpawnerIndex::GT_Build()
+{
+	Index.Empty();
+
+	if(bScoped)
+	{
+		UE_LOG(LogKantanDocGen, Log, TEXT("Using scoped action refresh, spawners will be created per documented object."));
+		return;
+	}
+
+	auto const& BPActionMap = FBlueprintActionDatabase::Get().GetAllActions();
+	Index.Reserve(BPActionMap.Num());
+
+	int32 SpawnerCount = 0;
+	for(auto const& Entry : BPActionMap)
+	{
+		auto Obj = Entry.Key.ResolveObjectPtr();
+		if(Obj == nullptr || Entry.Value.Num() == 0 || IsSourceObjectExcluded(Obj))
+		{
+			continue;
+		}
+
+		auto& Spawners = Index.Add(Entry.Key);
+		FilterSpawners(Obj, Entry.Value, Spawners);
+		SpawnerCount += Spawners.Num();
+	}
+
+	UE_LOG(LogKantanDocGen, Log, TEXT("Spawner index built with %i documentable spawners across %i source objects."), SpawnerCount, Index.Num());
+}
+
+bool FDocGenSpawnerIndex::GT_TakeSpawners(UObject* Obj, FSpawnerList& OutSpawners)
+{
+	OutSpawners.Reset();
+
+	if(IsSourceObjectExcluded(Obj))
+	{
+		return false;
+	}
+
+	if(bScoped)
+	{
+		// Anything the previous object produced has been spawned by now
+		ReleaseScopedSpawners();
+		CreateScopedSpawners(Obj, ScopedSpawners);
+		FilterSpawners(Obj, ScopedSpawners, OutSpawners);
+		return OutSpawners.Num() > 0;
+	}
+
+	FObjectKey const Key(Obj);
+	if(auto Indexed = Index.Find(Key))
+	{
+		OutSpawners = MoveTemp(*Indexed);
+		Index.Remove(Key);
+	}
+	else if(auto ActionList = FBlueprintActionDatabase::Get().GetAllActions().Find(Obj))
+	{
+		// Not in the database when the index was built, eg. a blueprint loaded by enumeration
+		FilterSpawners(Obj, *ActionList, OutSpawners);
+	}
+
+	return OutSpawners.Num() > 0;
+}
+
+/*
+Mirrors the function and event actions the database registers for a class, which is all that can be documented for
+a class or blueprint without going through the database. Node types which register their own menu actions aren't
+included.
+*/
+void FDocGenSpawnerIndex::CreateScopedSpawners(UObject* Obj, TArray< UBlueprintNodeSpawner* >& OutActions) const
+{
+	auto Blueprint = Cast< UBlueprint >(Obj);
+	UClass* Class = Blueprint ? Blueprint->GeneratedClass : Cast< UClass >(Obj);
+	if(Class == nullptr)
+	{
+		return;
+	}
+
+	for(TFieldIterator< UFunction > FuncIt(Class, EFieldIteratorFlags::ExcludeSuper); FuncIt; ++FuncIt)
+	{
+		auto Func = *FuncIt;
+
+		UBlueprintNodeSpawner* Spawner = nullptr;
+		if(UEdGraphSchema_K2::CanUserKismetCallFunction(Func))
+		{
+			Spawner = UBlueprintFunctionNodeSpawner::Create(Func);
+		}
+		else if(Blueprint == nullptr && UEdGraphSchema_K2::FunctionCanBePlacedAsEvent(Func))
+		{
+			Spawner = UBlueprintEventNodeSpawner::Create(Func);
+		}
+
+		if(Spawner)
+		{
+			Spawner->AddToRoot();
+			OutActions.Add(Spawner);
+		}
+	}
+}
+
+void FDocGenSpawnerIndex::ReleaseScopedSpawners()
+{
+	for(auto Spawner : ScopedSpawners)
+	{
+		Spawner->RemoveFromRoot();
+	}
+	ScopedSpawners.Empty();
+}
+
+bool FDocGenSpawnerIndex::IsSourceObjectExcluded(UObject* Obj) const
+{
+	if(Exclusions == nullptr)
+	{
+		return false;
+	}
+
+	if(auto Class = Cast< UClass >(Obj))
+	{
+		return Exclusions->IsClassExcluded(Class);
+	}
+	else if(auto Blueprint = Cast< UBlueprint >(Obj))
+	{
+		return Exclusions->IsClassExcluded(Blueprint->GeneratedClass);
+	}
+
+	return false;
+}
+
+void FDocGenSpawnerIndex::FilterSpawners(UObject* Obj, TArray< UBlueprintNodeSpawner* > const& Actions, FSpawnerList& OutSpawners)
+{
+	bool const bIsBlueprint = Obj->IsA< UBlueprint >();
+
+	OutSpawners.Reserve(OutSpawners.Num() + Actions.Num());
+	for(auto Spawner : Actions)
+	{
+		if(Spawner && IsSpawnerDocumentable(Spawner, bIsBlueprint))
+		{
+			OutSpawners.Add(Spawner);
+		}
+	}
+}
+
+bool FDocGenSpawnerIndex::IsSpawnerDocumentable(UBlueprintNodeSpawner* Spawner, bool bIsBlueprint)
+{
+	// Function spawners for functions with any of the following metadata tags will also be excluded
+	static const FName ExcludedFunctionMeta[] = {
+		TEXT("BlueprintAutocast")
+	};
+
+	static const uint32 PermittedAccessSpecifiers = (FUNC_Public | FUNC_Protected);
+
+
+	if(IsSpawnerClassExcluded(Spawner->GetClass(), bIsBlueprint))
+	{
+		return false;
+	}
+
+	if(Spawner->NodeClass && IsNodeClassExcluded(Spawner->NodeClass))
+	{
+		return false;
+	}
+
+	if(auto FuncSpawner = Cast< UBlueprintFunctionNodeSpawner >(Spawner))
+	{
+		auto Func = FuncSpawner->GetFunction();
+
+		// @NOTE: We exclude based on access level, but only if this is not a spawner for a blueprint event
+		// (custom events do not have any access specifiers)
+		if((Func->FunctionFlags & FUNC_BlueprintEvent) == 0 && (Func->FunctionFlags & PermittedAccessSpecifiers) == 0)
+		{
+			return false;
+		}
+
+		for(auto const& Meta : ExcludedFunctionMeta)
+		{
+			if(Func->HasMetaData(Meta))
+			{
+				return false;
+			}
+		}
+
+		// Functions are documented under their owning class, which may differ from the source object
+		if(Exclusions && (Exclusions->IsFunctionExcluded(Func) || Exclusions->IsClassExcluded(Func->GetOwnerClass())))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FDocGenSpawnerIndex::IsSpawnerClassExcluded(UClass* SpawnerClass, bool bIsBlueprint)
+{
+	// Spawners of or deriving from the following classes will be excluded
+	static const TSubclassOf< UBlueprintNodeSpawner > ExcludedSpawnerClasses[] = {
+		UBlueprintVariableNodeSpawner::StaticClass(),
+		UBlueprintDelegateNodeSpawner::StaticClass(),
+		UBlueprintBoundNodeSpawner::StaticClass(),
+		UBlueprintComponentNodeSpawner::StaticClass(),
+	};
+
+	// Spawners of or deriving from the following classes will be excluded in a blueprint context
+	static const TSubclassOf< UBlueprintNodeSpawner > BlueprintOnlyExcludedSpawnerClasses[] = {
+		UBlueprintEventNodeSpawner::StaticClass(),
+	};
+
+	auto& Exclusions = bIsBlueprint ? BlueprintSpawnerClassExclusions : SpawnerClassExclusions;
+	if(auto Memoized = Exclusions.Find(SpawnerClass))
+	{
+		return *Memoized;
+	}
+
+	bool bExcluded = false;
+	for(auto ExclSpawnerClass : ExcludedSpawnerClasses)
+	{
+		bExcluded |= SpawnerClass->IsChildOf(ExclSpawnerClass);
+	}
+
+	if(bIsBlueprint)
+	{
+		for(auto ExclSpawnerClass : BlueprintOnlyExcludedSpawnerClasses)
+		{
+			bExcluded |= SpawnerClass->IsChildOf(ExclSpawnerClass);
+		}
+	}
+
+	Exclusions.Add(SpawnerClass, bExcluded);
+	return bExcluded;
+}
+
+bool FDocGenSpawnerIndex::IsNodeClassExcluded(UClass* NodeClass)
+{
+	// Spawners for nodes of these types (or their subclasses) will be excluded
+	static const TSubclassOf< UK2Node > ExcludedNodeClasses[] = {
+		UK2Node_DynamicCast::StaticClass(),
+		UK2Node_Message::StaticClass(),
+	};
+
+	if(auto Memoized = NodeClassExclusions.Find(NodeClass))
+	{
+		return *Memoized;
+	}
+
+	bool bExcluded = false;
+	for(auto ExclNodeClass : ExcludedNodeClasses)
+	{
+		bExcluded |= NodeClass->IsChildOf(ExclNodeClass);
+	}
+
+	NodeClassExclusions.Add(NodeClass, bExcluded);
+	return bExcluded;
+}
+
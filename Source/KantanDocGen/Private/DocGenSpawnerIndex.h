@@ -0,0 +1,68 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+#include "UObject/ObjectKey.h"
+
+
+class UClass;
+class UBlueprintNodeSpawner;
+class FDocGenExclusionRules;
+
+/*
+Documentable spawners for every source object in the blueprint action database, filtered once up front.
+In scoped mode, the action database isn't used at all. Instead, function and event spawners are created directly from
+each object's class as it is taken, so the cost is independent of how many classes are loaded in the editor.
+Exclusion decisions which depend only on the spawner or node class are memoized.
+Game thread only.
+*/
+class FDocGenSpawnerIndex
+{
+public:
+	FDocGenSpawnerIndex(bool bInScoped = false, FDocGenExclusionRules const* InExclusions = nullptr):
+		bScoped(bInScoped)
+		, Exclusions(InExclusions)
+	{}
+	~FDocGenSpawnerIndex();
+
+public:
+	typedef TArray< TWeakObjectPtr< UBlueprintNodeSpawner > > FSpawnerList;
+
+public:
+	/** Builds the index from the current contents of the blueprint action database. Does nothing in scoped mode. */
+	void GT_Build();
+	/**
+	Moves the documentable spawners for Obj into OutSpawners, returns false if there are none.
+	Objects registered with the database since the index was built are filtered on demand.
+	In scoped mode, the spawners are only kept alive until the next call.
+	*/
+	bool GT_TakeSpawners(UObject* Obj, FSpawnerList& OutSpawners);
+
+	bool IsSpawnerDocumentable(UBlueprintNodeSpawner* Spawner, bool bIsBlueprint);
+
+protected:
+	void CreateScopedSpawners(UObject* Obj, TArray< UBlueprintNodeSpawner* >& OutActions) const;
+	void ReleaseScopedSpawners();
+	bool IsSourceObjectExcluded(UObject* Obj) const;
+	void FilterSpawners(UObject* Obj, TArray< UBlueprintNodeSpawner* > const& Actions, FSpawnerList& OutSpawners);
+	bool IsSpawnerClassExcluded(UClass* SpawnerClass, bool bIsBlueprint);
+	bool IsNodeClassExcluded(UClass* NodeClass);
+
+protected:
+	bool bScoped;
+	FDocGenExclusionRules const* Exclusions;
+	TMap< FObjectKey, FSpawnerList > Index;
+	// Spawners created for the object most recently taken in scoped mode, rooted until the next is taken
+	TArray< UBlueprintNodeSpawner* > ScopedSpawners;
+
+	TMap< UClass*, bool > SpawnerClassExclusions;
+	TMap< UClass*, bool > BlueprintSpawnerClassExclusions;
+	TMap< UClass*, bool > NodeClassExclusions;
+};
+
@@ -15,17 +15,38 @@
 #include "Enumeration/NativeModuleEnumerator.h"
 #include "Enumeration/ContentPathEnumerator.h"
 #include "Enumeration/CompositeEnumerator.h"
+#include "Output/HtmlDocRenderer.h"
+#include "DocGenManifest.h"
+#include "DocGenSpawnerIndex.h"
+#include "DocGenExclusionRules.h"
 #include "Widgets/Notifications/SNotificationList.h"
 #include "Framework/Notifications/NotificationManager.h"
 #include "ThreadingHelpers.h"
 #include "Interfaces/IPluginManager.h"
 #include "HAL/FileManager.h"
 #include "HAL/PlatformProcess.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Stats/StatsMisc.h"
+#include "HAL/PlatformMemory.h"
+#include "UObject/UObjectGlobals.h"
 
 
 #define LOCTEXT_NAMESPACE "KantanDocGen"
 
 
+/*
+State captured for a node on the game thread. The node itself is released as soon as this is taken.
+*/
+struct FCapturedNode
+{
+	FNodeDocsGenerator::FNodeProcessingState State;
+
+	FCapturedNode():
+		State()
+	{}
+};
+
+
 FDocGenTaskProcessor::FDocGenTaskProcessor()
 {
 	bRunning = false;
@@ -53,6 +74,15 @@ void FDocGenTaskProcessor::QueueTask(FKantanDocGenSettings const& Settings)
 	Waiting.Enqueue(NewTask);
 }
 
+FDocGenTaskProcessor::EDocGenResult FDocGenTaskProcessor::RunTaskSynchronous(FKantanDocGenSettings const& Settings)
+{
+	TSharedPtr< FDocGenTask > Task = MakeShared< FDocGenTask >();
+	Task->Settings = Settings;
+
+	// Game thread work is dispatched to the task graph and waited on, which the game thread services itself while waiting
+	return ProcessTask(Task);
+}
+
 bool FDocGenTaskProcessor::IsRunning() const
 {
 	return bRunning;
@@ -85,35 +115,39 @@ void FDocGenTaskProcessor::Stop()
 	bTerminationRequest = true;
 }
 
-void FDocGenTaskProcessor::ProcessTask(TSharedPtr< FDocGenTask > InTask)
+FDocGenTaskProcessor::EDocGenResult FDocGenTaskProcessor::ProcessTask(TSharedPtr< FDocGenTask > InTask)
 {
 	/********** Lambdas for the game thread to execute **********/
 	
-	auto GameThread_InitDocGen = [this](FString const& DocTitle, FString const& IntermediateDir) -> bool
+	auto GameThread_InitDocGen = [this](FString const& DocsDir) -> bool
 	{
-		Current->Task->Notification->SetExpireDuration(2.0f);
-		Current->Task->Notification->SetText(LOCTEXT("DocGenInProgress", "Doc gen in progress"));
+		if(Current->Task->Notification.IsValid())
+		{
+			Current->Task->Notification->SetExpireDuration(2.0f);
+			Current->Task->Notification->SetText(LOCTEXT("DocGenInProgress", "Doc gen in progress"));
+		}
 
-		return Current->DocGen->GT_Init(DocTitle, IntermediateDir, Current->Task->Settings.BlueprintContextClass);
+		return Current->DocGen->GT_Init(Current->Task->Settings, DocsDir, Current->Manifest.Get());
 	};
 
 	TFunction<void()> GameThread_EnqueueEnumerators = [this]()
 	{
 		// @TODO: Specific class enumerator
-		Current->Enumerators.Enqueue(MakeShared< FCompositeEnumerator< FNativeModuleEnumerator > >(Current->Task->Settings.NativeModules));
+		Current->Enumerators.Enqueue(MakeShared< FCompositeEnumerator< FNativeModuleEnumerator > >(Current->Task->Settings.NativeModules, Current->Exclusions.Get()));
 
 		TArray< FName > ContentPackagePaths;
 		for (auto const& Path : Current->Task->Settings.ContentPaths)
 		{
 			ContentPackagePaths.AddUnique(FName(*Path.Path));
 		}
-		Current->Enumerators.Enqueue(MakeShared< FCompositeEnumerator< FContentPathEnumerator > >(ContentPackagePaths));
+		Current->Enumerators.Enqueue(MakeShared< FCompositeEnumerator< FContentPathEnumerator > >(ContentPackagePaths, Current->Task->Settings.AssetPrefetchCount, Current->Exclusions.Get()));
 	};
 
 	auto GameThread_EnumerateNextObject = [this]() -> bool
 	{
 		Current->SourceObject.Reset();
-		Current->CurrentSpawners.Empty();
+		Current->CurrentSpawners.Reset();
+		Current->NextSpawner = 0;
 
 		while(auto Obj = Current->CurrentEnumerator->GetNext())
 		{
@@ -123,21 +157,10 @@ void FDocGenTaskProcessor::ProcessTask(TSharedPtr< FDocGenTask > InTask)
 				continue;
 			}
 
-			// Cache list of spawners for this object
-			auto& BPActionMap = FBlueprintActionDatabase::Get().GetAllActions();
-			if(auto ActionList = BPActionMap.Find(Obj))
+			// Take the prefiltered list of spawners for this object
+			if(Current->SpawnerIndex->GT_TakeSpawners(Obj, Current->CurrentSpawners))
 			{
-				if(ActionList->Num() == 0)
-				{
-					continue;
-				}
-
 				Current->SourceObject = Obj;
-				for(auto Spawner : *ActionList)
-				{
-					// Add to queue as weak ptr
-					check(Current->CurrentSpawners.Enqueue(Spawner));
-				}
 
 				// Done
 				Current->Processed.Add(Obj);
@@ -149,21 +172,34 @@ void FDocGenTaskProcessor::ProcessTask(TSharedPtr< FDocGenTask > InTask)
 		return false;
 	};
 
-	auto GameThread_EnumerateNextNode = [this](FNodeDocsGenerator::FNodeProcessingState& OutState) -> UK2Node*
+	// Outputs null for nodes documented by reflection, which aren't spawned
+	auto GameThread_EnumerateNextNode = [this](FNodeDocsGenerator::FNodeProcessingState& OutState, UK2Node*& OutNode) -> bool
 	{
+		OutNode = nullptr;
+
 		// We've just come in from another thread, check the source object is still around
 		if(!Current->SourceObject.IsValid())
 		{
 			UE_LOG(LogKantanDocGen, Warning, TEXT("Object being enumerated expired!"));
-			return nullptr;
+			return false;
 		}
 
 		// Try to grab the next spawner in the cached list
-		TWeakObjectPtr< UBlueprintNodeSpawner > Spawner;
-		while(Current->CurrentSpawners.Dequeue(Spawner))
+		while(Current->NextSpawner < Current->CurrentSpawners.Num())
 		{
+			auto const& Spawner = Current->CurrentSpawners[Current->NextSpawner++];
 			if(Spawner.IsValid())
 			{
+				if(Current->DocGen->CanDocumentByReflection(Spawner.Get()))
+				{
+					if(Current->DocGen->GT_InitializeForFunction(Spawner.Get(), OutState))
+					{
+						return true;
+					}
+
+					continue;
+				}
+
 				// See if we can document this spawner
 				auto K2_NodeInst = Current->DocGen->GT_InitializeForSpawner(Spawner.Get(), Current->SourceObject.Get(), OutState);
 
@@ -172,29 +208,105 @@ void FDocGenTaskProcessor::ProcessTask(TSharedPtr< FDocGenTask > InTask)
 					continue;
 				}
 
-				// Make sure this node object will never be GCd until we're done with it.
-				K2_NodeInst->AddToRoot();
-				return K2_NodeInst;
+				// Rooted by the generator until released
+				OutNode = K2_NodeInst;
+				return true;
 			}
 		}
 
 		// No spawners left in the queue
-		return nullptr;
+		return false;
 	};
 
-	auto GameThread_FinalizeDocs = [this](FString const& OutputPath) -> bool
+	auto GameThread_EnumerateNextNodeBatch = [this, GameThread_EnumerateNextNode](TArray< FCapturedNode >& OutBatch) -> bool
 	{
-		bool const Result = Current->DocGen->GT_Finalize(OutputPath);
+		OutBatch.Reset();
+
+		// Previous batch was fully captured and released before returning, so the graph can be safely rotated here
+		Current->DocGen->GT_BeginNodeBatch();
 
-		if (!Result)
+		// Spawn and capture as many nodes as the batch size allows within this single game thread dispatch,
+		// so that the number of thread hops scales with batches rather than nodes.
+		int32 const BatchSize = FMath::Max(Current->Task->Settings.NodeBatchSize, 1);
+		TArray< UK2Node* > SpawnedNodes;
+		while(OutBatch.Num() < BatchSize)
 		{
-			Current->Task->Notification->SetText(LOCTEXT("DocFinalizationFailed", "Doc gen failed"));
-			Current->Task->Notification->SetCompletionState(SNotificationItem::CS_Fail);
-			Current->Task->Notification->ExpireAndFadeout();
-			//GEditor->PlayEditorSound(CompileSuccessSound);
+			FNodeDocsGenerator::FNodeProcessingState NodeState;
+			UK2Node* NodeInst = nullptr;
+			if(!GameThread_EnumerateNextNode(NodeState, NodeInst))
+			{
+				break;
+			}
+
+			SpawnedNodes.Add(NodeInst);
+
+			FCapturedNode Entry;
+			Entry.State = MoveTemp(NodeState);
+			OutBatch.Add(MoveTemp(Entry));
 		}
 
-		return Result;
+		// Nodes unchanged since the previous run, or with a cached image, don't need rendering
+		TArray< int32 > CaptureIndices;
+		TArray< UEdGraphNode* > CaptureNodes;
+		TArray< FNodeDocsGenerator::FNodeProcessingState* > CaptureStates;
+		for(int32 Idx = 0; Idx < OutBatch.Num(); ++Idx)
+		{
+			if(OutBatch[Idx].State.NeedsImageCapture())
+			{
+				CaptureIndices.Add(Idx);
+				CaptureNodes.Add(SpawnedNodes[Idx]);
+				CaptureStates.Add(&OutBatch[Idx].State);
+			}
+		}
+
+		TArray< bool > Captured;
+		Current->DocGen->GT_CaptureNodeImages(CaptureNodes, CaptureStates, Captured);
+
+		// Everything needed from the nodes is now in their records and pixels, so they never outlive the batch
+		Current->DocGen->GT_ReleaseNodes(SpawnedNodes);
+
+		int32 const NumEnumerated = OutBatch.Num();
+		for(int32 Idx = CaptureIndices.Num() - 1; Idx >= 0; --Idx)
+		{
+			if(!Captured[Idx])
+			{
+				UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to capture node image!"));
+				Current->DocGen->AbandonNode(OutBatch[CaptureIndices[Idx]].State);
+				OutBatch.RemoveAt(CaptureIndices[Idx]);
+			}
+		}
+
+		// Keep going if the whole batch failed but there may be more spawners
+		return NumEnumerated > 0;
+	};
+
+	auto GameThread_MemoryCheckpoint = [this]
+	{
+		uint64 const BudgetBytes = (uint64)FMath::Max(Current->Task->Settings.MemoryBudgetMB, 0) * 1024 * 1024;
+		uint64 UsedBytes = FPlatformMemory::GetStats().UsedPhysical;
+		Current->PeakUsedPhysical = FMath::Max(Current->PeakUsedPhysical, UsedBytes);
+		if(BudgetBytes > 0 && UsedBytes > BudgetBytes)
+		{
+			// Releases processed blueprints and nodes, anything still being documented is referenced by the enumerator
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			++Current->GarbageCollectionCount;
+
+			UsedBytes = FPlatformMemory::GetStats().UsedPhysical;
+			UE_LOG(LogKantanDocGen, Log, TEXT("Memory budget exceeded, collected garbage (%.1f MB now in use)."), UsedBytes / (1024.0 * 1024.0));
+		}
+	};
+
+	auto GameThread_FinalizeDocs = [this]
+	{
+		Current->DocGen->GT_Finalize();
+	};
+
+	auto GameThread_NotifyFinalizeFailed = [this]
+	{
+		Current->Task->Notification->SetText(LOCTEXT("DocFinalizationFailed", "Doc gen failed"));
+		Current->Task->Notification->SetCompletionState(SNotificationItem::CS_Fail);
+		Current->Task->Notification->ExpireAndFadeout();
+		//GEditor->PlayEditorSound(CompileSuccessSound);
 	};
 
 	/*****************************/
@@ -205,94 +317,229 @@ void FDocGenTaskProcessor::ProcessTask(TSharedPtr< FDocGenTask > InTask)
 
 	FString IntermediateDir = FPaths::ProjectIntermediateDir() / TEXT("KantanDocGen") / Current->Task->Settings.DocumentationTitle;
 
+	// In direct html mode, docs are written straight to their final location rather than the intermediate directory
+	bool const bDirectHtml = Current->Task->Settings.bDirectHtmlOutput;
+	FString const HtmlDocsDir = Current->Task->Settings.OutputDirectory.Path / Current->Task->Settings.DocumentationTitle;
+	FString const DocsDir = bDirectHtml ? HtmlDocsDir : IntermediateDir;
+
+	// For incremental generation, the manifest from the previous run determines which nodes can be skipped
+	FString const ManifestPath = DocsDir / TEXT("DocGenManifest.txt");
+	bool bHavePreviousRun = false;
+	if(Current->Task->Settings.bIncrementalGeneration)
+	{
+		Current->Manifest = MakeUnique< FDocGenManifest >();
+		bHavePreviousRun = Current->Manifest->Load(ManifestPath, FDocGenManifest::HashSettings(Current->Task->Settings));
+	}
+
+	// Compiled up front so that excluded classes are never loaded or spawned
+	Current->Exclusions = MakeUnique< FDocGenExclusionRules >(Current->Task->Settings);
+	if(Current->Exclusions->IsEmpty())
+	{
+		// Consumers skip rule evaluation, and the memoized class decisions, entirely without rules
+		Current->Exclusions.Reset();
+	}
+
 	DocGenThreads::RunOnGameThread(GameThread_EnqueueEnumerators);	
 
+	// Filter all spawners up front, so enumerating an object is just a handoff of its list
+	Current->SpawnerIndex = MakeUnique< FDocGenSpawnerIndex >(Current->Task->Settings.bScopedActionRefresh, Current->Exclusions.Get());
+	DocGenThreads::RunOnGameThread([this]
+		{
+			Current->SpawnerIndex->GT_Build();
+		});
+
 	// Initialize the doc generator
 	Current->DocGen = MakeUnique< FNodeDocsGenerator >();
 
-	if(!DocGenThreads::RunOnGameThreadRetVal(GameThread_InitDocGen, Current->Task->Settings.DocumentationTitle, IntermediateDir))
+	if(!DocGenThreads::RunOnGameThreadRetVal(GameThread_InitDocGen, DocsDir))
 	{
 		UE_LOG(LogKantanDocGen, Error, TEXT("Failed to initialize doc generator!"));
-		return;
+		return EDocGenResult::GenerationFailed;
 	}
 
-	bool const bCleanIntermediate = true;
-	if(bCleanIntermediate)
+	if(bDirectHtml)
 	{
-		IFileManager::Get().DeleteDirectory(*IntermediateDir, false, true);
-	}
+		if(Current->Task->Settings.Converter != EKantanDocGenConverter::Native)
+		{
+			UE_LOG(LogKantanDocGen, Warning, TEXT("Direct html output always uses the native converter, ignoring converter setting."));
+		}
 
-	for(auto const& Name : Current->Task->Settings.ExcludedClasses)
+		if(Current->Task->Settings.bCleanOutputDirectory)
+		{
+			IFileManager::Get().DeleteDirectory(*HtmlDocsDir, false, true);
+		}
+
+		if(!FHtmlDocRenderer::CopyStylesheet(HtmlDocsDir))
+		{
+			UE_LOG(LogKantanDocGen, Warning, TEXT("Docs will be generated without a stylesheet."));
+		}
+	}
+	else
 	{
-		Current->Excluded.Add(Name);
+		bool const bCleanIntermediate = !bHavePreviousRun;
+		if(bCleanIntermediate)
+		{
+			IFileManager::Get().DeleteDirectory(*IntermediateDir, false, true);
+		}
 	}
 
-	int SuccessfulNodeCount = 0;
+	FThreadSafeCounter SuccessfulNodeCount;
+
+	// Captured nodes are handed off to task graph workers for image encoding and doc serialization,
+	// with the window bounding how many nodes can be in flight at once.
+	DocGenThreads::FBoundedTaskWindow NodePipeline(Current->Task->Settings.MaxNodesInFlight);
+
+	auto ProcessCapturedNode = [this, &SuccessfulNodeCount](TSharedPtr< FCapturedNode > Entry)
+	{
+		// Node has already been released, everything needed is in the captured state
+
+		// Write image
+		if(!Current->DocGen->WriteNodeImage(Entry->State))
+		{
+			UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to generate node image!"))
+		}
+		// Generate doc
+		else if(!Current->DocGen->GenerateNodeDocs(Entry->State))
+		{
+			UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to generate node doc xml!"))
+		}
+		else
+		{
+			SuccessfulNodeCount.Increment();
+			return;
+		}
+
+		Current->DocGen->AbandonNode(Entry->State);
+	};
+
 	while(Current->Enumerators.Dequeue(Current->CurrentEnumerator))
 	{
 		while(DocGenThreads::RunOnGameThreadRetVal(GameThread_EnumerateNextObject))	// Game thread: Enumerate next Obj, get spawner list for Obj, store as array of weak ptrs.
 		{
 			if(bTerminationRequest)
 			{
-				return;
+				return EDocGenResult::Cancelled;
 			}
 
-			FNodeDocsGenerator::FNodeProcessingState NodeState;
-			while(auto NodeInst = DocGenThreads::RunOnGameThreadRetVal(GameThread_EnumerateNextNode, NodeState))	// Game thread: Get next still valid spawner, spawn node, add to root, return it)
+			TArray< FCapturedNode > NodeBatch;
+			for(;;)
 			{
-				// NodeInst should hopefully not reference anything except stuff we control (ie graph object), and it's rooted so should be safe to deal with here
+				// Don't capture more until the downstream stages have room for a full batch
+				NodePipeline.WaitForCapacity(Current->Task->Settings.NodeBatchSize);
 
-				// Generate image
-				if(!Current->DocGen->GenerateNodeImage(NodeInst, NodeState))
+				if(!DocGenThreads::RunOnGameThreadRetVal(GameThread_EnumerateNextNodeBatch, NodeBatch))	// Game thread: Get next batch of still valid spawners, spawn nodes, add to root, capture images
 				{
-					UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to generate node image!"))
-					continue;
+					break;
 				}
 
-				// Generate doc
-				if(!Current->DocGen->GenerateNodeDocs(NodeInst, NodeState))
+				for(auto& Entry : NodeBatch)
 				{
-					UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to generate node doc xml!"))
-					continue;
+					TSharedPtr< FCapturedNode > Captured = MakeShared< FCapturedNode >(MoveTemp(Entry));
+					NodePipeline.Dispatch([ProcessCapturedNode, Captured]
+					{
+						ProcessCapturedNode(Captured);
+					});
 				}
+			}
+
+			// Classes with no more nodes in flight are done with unless a later object maps nodes to them, so release them now
+			Current->DocGen->FlushClassDocs();
+
+			// Game thread: memory checkpoint, garbage collecting if over the memory budget. Nodes were already released with their batch.
+			DocGenThreads::RunOnGameThread(GameThread_MemoryCheckpoint);
+		}
+	}
+
+	// Everything must be written out before finalizing
+	NodePipeline.Drain();
+	DocGenThreads::RunOnGameThread(GameThread_MemoryCheckpoint);
 
-				++SuccessfulNodeCount;
+	if(Current->Manifest.IsValid())
+	{
+		// Remove artifacts of nodes which no longer exist
+		auto const StaleNodes = Current->Manifest->GetStaleNodes();
+		for(auto const& NodeKey : StaleNodes)
+		{
+			FString ClassId, NodeId;
+			if(FDocGenManifest::SplitNodeKey(NodeKey, ClassId, NodeId))
+			{
+				Current->DocGen->RemoveNodeArtifacts(ClassId, NodeId);
+				if(!bDirectHtml)
+				{
+					// Converted output of the previous run
+					IFileManager::Get().Delete(*(HtmlDocsDir / ClassId / TEXT("nodes") / (NodeId + TEXT(".html"))), false, false, true);
+					IFileManager::Get().Delete(*(HtmlDocsDir / ClassId / TEXT("img") / FNodeDocsGenerator::GetNodeImageFilename(NodeId)), false, false, true);
+				}
 			}
 		}
+
+		UE_LOG(LogKantanDocGen, Log, TEXT("Incremental generation removed %i stale nodes."), StaleNodes.Num());
 	}
 
-	if(SuccessfulNodeCount == 0)
+	int32 const FailedImageCount = Current->DocGen->FlushImageWrites();
+	if(FailedImageCount > 0)
+	{
+		UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to write %i node images!"), FailedImageCount);
+	}
+
+	if(Current->Task->Settings.bUseImageCache)
+	{
+		UE_LOG(LogKantanDocGen, Log, TEXT("%i node images were taken from the image cache."), Current->DocGen->GetImageCacheHits());
+	}
+
+	if(SuccessfulNodeCount.GetValue() == 0)
 	{
 		UE_LOG(LogKantanDocGen, Error, TEXT("No nodes were found to document!"));
 
-		DocGenThreads::RunOnGameThread([this]
-			{
-				Current->Task->Notification->SetText(LOCTEXT("DocFinalizationFailed", "Doc gen failed - No nodes found"));
-				Current->Task->Notification->SetCompletionState(SNotificationItem::CS_Fail);
-				Current->Task->Notification->ExpireAndFadeout();
-			});
+		if(Current->Task->Notification.IsValid())
+		{
+			DocGenThreads::RunOnGameThread([this]
+				{
+					Current->Task->Notification->SetText(LOCTEXT("DocFinalizationFailed", "Doc gen failed - No nodes found"));
+					Current->Task->Notification->SetCompletionState(SNotificationItem::CS_Fail);
+					Current->Task->Notification->ExpireAndFadeout();
+				});
+		}
 		//GEditor->PlayEditorSound(CompileSuccessSound);
-		return;
+		return EDocGenResult::NoNodes;
 	}
 
 	// Game thread: DocGen.GT_Finalize()
-	if(!DocGenThreads::RunOnGameThreadRetVal(GameThread_FinalizeDocs, IntermediateDir))
+	DocGenThreads::RunOnGameThread(GameThread_FinalizeDocs);
+
+	// Remaining class docs and the index are serialized here, off the game thread
+	if(!Current->DocGen->Finalize(DocsDir))
 	{
-		UE_LOG(LogKantanDocGen, Error, TEXT("Failed to finalize xml docs!"));
-		return;
+		if(Current->Task->Notification.IsValid())
+		{
+			DocGenThreads::RunOnGameThread(GameThread_NotifyFinalizeFailed);
+		}
+
+		UE_LOG(LogKantanDocGen, Error, TEXT("Failed to finalize docs!"));
+		return EDocGenResult::GenerationFailed;
 	}
 
-	DocGenThreads::RunOnGameThread([this]
+	auto TransformationResult = EIntermediateProcessingResult::Success;
+	if(!bDirectHtml)
+	{
+		if(Current->Task->Notification.IsValid())
 		{
-			Current->Task->Notification->SetText(LOCTEXT("DocConversionInProgress", "Converting docs"));
-		});
+			DocGenThreads::RunOnGameThread([this]
+				{
+					Current->Task->Notification->SetText(LOCTEXT("DocConversionInProgress", "Converting docs"));
+				});
+		}
+
+		TransformationResult = ProcessIntermediateDocs(
+			Current->Task->Settings.Converter,
+			IntermediateDir,
+			Current->Task->Settings.OutputDirectory.Path,
+			Current->Task->Settings.DocumentationTitle,
+			Current->Task->Settings.bCleanOutputDirectory,
+			bHavePreviousRun
+		);
+	}
 
-	auto TransformationResult = ProcessIntermediateDocs(
-		IntermediateDir,
-		Current->Task->Settings.OutputDirectory.Path,
-		Current->Task->Settings.DocumentationTitle,
-		Current->Task->Settings.bCleanOutputDirectory
-	);
 	if(TransformationResult != EIntermediateProcessingResult::Success)
 	{
 		UE_LOG(LogKantanDocGen, Error, TEXT("Failed to transform xml to html!"));
@@ -300,48 +547,120 @@ void FDocGenTaskProcessor::ProcessTask(TSharedPtr< FDocGenTask > InTask)
 		auto Msg = FText::Format(LOCTEXT("DocConversionFailed", "Doc gen failed - {0}"),
 			TransformationResult == EIntermediateProcessingResult::DiskWriteFailure ? LOCTEXT("CouldNotWriteToOutput", "Could not write output, please clear output directory or enable 'Clean Output Directory' option") : LOCTEXT("GenericTransformationFailure", "Conversion failure")
 			);
-		DocGenThreads::RunOnGameThread([this, Msg]
-			{
-				Current->Task->Notification->SetText(Msg);
-				Current->Task->Notification->SetCompletionState(SNotificationItem::CS_Fail);
-				Current->Task->Notification->ExpireAndFadeout();
-			});
+		if(Current->Task->Notification.IsValid())
+		{
+			DocGenThreads::RunOnGameThread([this, Msg]
+				{
+					Current->Task->Notification->SetText(Msg);
+					Current->Task->Notification->SetCompletionState(SNotificationItem::CS_Fail);
+					Current->Task->Notification->ExpireAndFadeout();
+				});
+		}
 		//GEditor->PlayEditorSound(CompileSuccessSound);
-		return;
+		return TransformationResult == EIntermediateProcessingResult::DiskWriteFailure ? EDocGenResult::DiskWriteFailure : EDocGenResult::ConversionFailed;
 	}
 
-	DocGenThreads::RunOnGameThread([this]
-		{
-			FString HyperlinkTarget = TEXT("file://") / FPaths::ConvertRelativePathToFull(Current->Task->Settings.OutputDirectory.Path / Current->Task->Settings.DocumentationTitle / TEXT("index.html"));
-			auto OnHyperlinkClicked = [HyperlinkTarget]
+	// Only record the run once everything has been output, so a failed run is fully regenerated next time
+	if(Current->Manifest.IsValid())
+	{
+		Current->Manifest->Save(ManifestPath);
+	}
+
+	if(Current->Task->Notification.IsValid())
+	{
+		DocGenThreads::RunOnGameThread([this]
 			{
-				UE_LOG(LogKantanDocGen, Log, TEXT("Invoking hyperlink"));
-				FPlatformProcess::LaunchURL(*HyperlinkTarget, nullptr, nullptr);
-			};
+				FString HyperlinkTarget = TEXT("file://") / FPaths::ConvertRelativePathToFull(Current->Task->Settings.OutputDirectory.Path / Current->Task->Settings.DocumentationTitle / TEXT("index.html"));
+				auto OnHyperlinkClicked = [HyperlinkTarget]
+				{
+					UE_LOG(LogKantanDocGen, Log, TEXT("Invoking hyperlink"));
+					FPlatformProcess::LaunchURL(*HyperlinkTarget, nullptr, nullptr);
+				};
 
-			auto const HyperlinkText = TAttribute< FText >::Create(TAttribute< FText >::FGetter::CreateLambda([] { return LOCTEXT("GeneratedDocsHyperlink", "View docs"); }));
-			// @TODO: Bug in SNotificationItemImpl::SetHyperlink, ignores non-delegate attributes... LOCTEXT("GeneratedDocsHyperlink", "View docs");
+				auto const HyperlinkText = TAttribute< FText >::Create(TAttribute< FText >::FGetter::CreateLambda([] { return LOCTEXT("GeneratedDocsHyperlink", "View docs"); }));
+				// @TODO: Bug in SNotificationItemImpl::SetHyperlink, ignores non-delegate attributes... LOCTEXT("GeneratedDocsHyperlink", "View docs");
 		
-			Current->Task->Notification->SetText(LOCTEXT("DocConversionSuccessful", "Doc gen completed"));
-			Current->Task->Notification->SetCompletionState(SNotificationItem::CS_Success);
-			Current->Task->Notification->SetHyperlink(
-				FSimpleDelegate::CreateLambda(OnHyperlinkClicked),
-				HyperlinkText
-			);
-			Current->Task->Notification->ExpireAndFadeout();
-		});
+				Current->Task->Notification->SetText(LOCTEXT("DocConversionSuccessful", "Doc gen completed"));
+				Current->Task->Notification->SetCompletionState(SNotificationItem::CS_Success);
+				Current->Task->Notification->SetHyperlink(
+					FSimpleDelegate::CreateLambda(OnHyperlinkClicked),
+					HyperlinkText
+				);
+				Current->Task->Notification->ExpireAndFadeout();
+			});
+	}
+
+	UE_LOG(LogKantanDocGen, Log, TEXT("Generated docs for %i nodes."), SuccessfulNodeCount.GetValue());
+	UE_LOG(LogKantanDocGen, Log, TEXT("Peak memory in use: %.1f MB at checkpoints, %.1f MB for the process (%i garbage collections)."),
+		Current->PeakUsedPhysical / (1024.0 * 1024.0), FPlatformMemory::GetStats().PeakUsedPhysical / (1024.0 * 1024.0), Current->GarbageCollectionCount);
 
 	Current.Reset();
+	return EDocGenResult::Success;
 }
 
-FDocGenTaskProcessor::EIntermediateProcessingResult FDocGenTaskProcessor::ProcessIntermediateDocs(FString const& IntermediateDir, FString const& OutputDir, FString const& DocTitle, bool bCleanOutput)
+FDocGenTaskProcessor::EIntermediateProcessingResult FDocGenTaskProcessor::ProcessIntermediateDocs(EKantanDocGenConverter Converter, FString const& IntermediateDir, FString const& OutputDir, FString const& DocTitle, bool bCleanOutput, bool bSkipUnchangedNodes)
+{
+	double ConversionTime = 0.0;
+	int32 ReturnCode = 0;
+	{
+		SCOPE_SECONDS_COUNTER(ConversionTime);
+
+		switch(Converter)
+		{
+			case EKantanDocGenConverter::ExternalTool:
+			ReturnCode = RunExternalConversionTool(IntermediateDir, OutputDir, DocTitle, bCleanOutput);
+			break;
+			default:
+			ReturnCode = FHtmlDocRenderer::ConvertIntermediateDocs(IntermediateDir, OutputDir, DocTitle, bCleanOutput, bSkipUnchangedNodes);
+			break;
+		}
+	}
+
+	UE_LOG(LogKantanDocGen, Log, TEXT("Html conversion took %.3fs."), ConversionTime);
+
+	switch(ReturnCode)
+	{
+		case 0:
+		return EIntermediateProcessingResult::Success;
+		case -1:
+		return EIntermediateProcessingResult::UnknownError;
+		case -2:
+		return EIntermediateProcessingResult::DiskWriteFailure;
+		default:
+		return EIntermediateProcessingResult::SuccessWithErrors;
+	}
+}
+
+void FDocGenTaskProcessor::BenchmarkConversion(FString const& IntermediateDir, FString const& OutputDir, FString const& DocTitle, int32 Iterations)
+{
+	Iterations = FMath::Max(Iterations, 1);
+
+	double NativeTime = 0.0;
+	double ExternalTime = 0.0;
+	for(int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		{
+			SCOPE_SECONDS_COUNTER(NativeTime);
+			FHtmlDocRenderer::ConvertIntermediateDocs(IntermediateDir, OutputDir / TEXT("Native"), DocTitle, true);
+		}
+		{
+			SCOPE_SECONDS_COUNTER(ExternalTime);
+			RunExternalConversionTool(IntermediateDir, OutputDir / TEXT("External"), DocTitle, true);
+		}
+	}
+
+	UE_LOG(LogKantanDocGen, Display, TEXT("Conversion benchmark for '%s' over %i iterations: native %.3fs, external tool %.3fs (average per run)."),
+		*DocTitle, Iterations, NativeTime / Iterations, ExternalTime / Iterations);
+}
+
+int32 FDocGenTaskProcessor::RunExternalConversionTool(FString const& IntermediateDir, FString const& OutputDir, FString const& DocTitle, bool bCleanOutput)
 {
 	auto& PluginManager = IPluginManager::Get();
 	auto Plugin = PluginManager.FindPlugin(TEXT("KantanDocGen"));
 	if(!Plugin.IsValid())
 	{
 		UE_LOG(LogKantanDocGen, Error, TEXT("Failed to locate plugin info"));
-		return EIntermediateProcessingResult::UnknownError;
+		return -1;
 	}
 
 	const FString DocGenToolBinPath = Plugin->GetBaseDir() / TEXT("ThirdParty") / TEXT("KantanDocGenTool") / TEXT("bin");
@@ -412,22 +731,17 @@ FDocGenTaskProcessor::EIntermediateProcessingResult FDocGenTaskProcessor::Proces
 			UE_LOG(LogKantanDocGen, Error, TEXT("KantanDocGen tool failed (code %i), see above output."), ReturnCode);
 		}
 	}
+	else
+	{
+		UE_LOG(LogKantanDocGen, Error, TEXT("Failed to launch KantanDocGen tool."));
+		ReturnCode = -1;
+	}
 
 	// Close the pipes
 	FPlatformProcess::ClosePipe(0, PipeRead);
 	FPlatformProcess::ClosePipe(0, PipeWrite);
 
-	switch(ReturnCode)
-	{
-		case 0:
-		return EIntermediateProcessingResult::Success;
-		case -1:
-		return EIntermediateProcessingResult::UnknownError;
-		case -2:
-		return EIntermediateProcessingResult::DiskWriteFailure;
-		default:
-		return EIntermediateProcessingResult::SuccessWithErrors;
-	}
+	return ReturnCode;
 }
 
 
@@ -17,8 +17,12 @@
 
 class ISourceObjectEnumerator;
 class FNodeDocsGenerator;
+class FDocGenManifest;
+class FDocGenSpawnerIndex;
+class FDocGenExclusionRules;
 
 class UBlueprintNodeSpawner;
+class UK2Node;
 
 
 class FDocGenTaskProcessor: public FRunnable
@@ -26,10 +30,25 @@ class FDocGenTaskProcessor: public FRunnable
 public:
 	FDocGenTaskProcessor();
 
+public:
+	enum class EDocGenResult: uint8 {
+		Success,
+		Cancelled,
+		GenerationFailed,
+		NoNodes,
+		ConversionFailed,
+		DiskWriteFailure,
+	};
+
 public:
 	void QueueTask(FKantanDocGenSettings const& Settings);
+	/** Processes a task to completion on the calling thread, without notifications. */
+	EDocGenResult RunTaskSynchronous(FKantanDocGenSettings const& Settings);
 	bool IsRunning() const;
 
+	/** Converts an existing intermediate doc set with both the native and external converters, logging wall times for each. */
+	static void BenchmarkConversion(FString const& IntermediateDir, FString const& OutputDir, FString const& DocTitle, int32 Iterations);
+
 public:
 	virtual bool Init() override;
 	virtual uint32 Run() override;
@@ -40,6 +59,7 @@ protected:
 	struct FDocGenTask
 	{
 		FKantanDocGenSettings Settings;
+		// Null when running without UI
 		TSharedPtr< class SNotificationItem > Notification;
 	};
 
@@ -48,14 +68,23 @@ protected:
 		TSharedPtr< FDocGenTask > Task;
 
 		TQueue< TSharedPtr< ISourceObjectEnumerator > > Enumerators;
-		TSet< FName > Excluded;
+		// Null if there are no exclusion rules
+		TUniquePtr< FDocGenExclusionRules > Exclusions;
 		TSet< TWeakObjectPtr< UObject > > Processed;
 
 		TSharedPtr< ISourceObjectEnumerator > CurrentEnumerator;
 		TWeakObjectPtr< UObject > SourceObject;
-		TQueue< TWeakObjectPtr< UBlueprintNodeSpawner > > CurrentSpawners;
+		TArray< TWeakObjectPtr< UBlueprintNodeSpawner > > CurrentSpawners;
+		int32 NextSpawner = 0;
+
+		TUniquePtr< FDocGenSpawnerIndex > SpawnerIndex;
+
+		uint64 PeakUsedPhysical = 0;
+		int32 GarbageCollectionCount = 0;
 
 		TUniquePtr< FNodeDocsGenerator > DocGen;
+		// Only used for incremental generation
+		TUniquePtr< FDocGenManifest > Manifest;
 	};
 
 	struct FDocGenOutputTask
@@ -64,7 +93,7 @@ protected:
 	};
 
 protected:
-	void ProcessTask(TSharedPtr< FDocGenTask > InTask);
+	EDocGenResult ProcessTask(TSharedPtr< FDocGenTask > InTask);
 
 	enum EIntermediateProcessingResult: uint8 {
 		Success,
@@ -73,7 +102,8 @@ protected:
 		DiskWriteFailure,
 	};
 
-	EIntermediateProcessingResult ProcessIntermediateDocs(FString const& IntermediateDir, FString const& OutputDir, FString const& DocTitle, bool bCleanOutput);
+	static EIntermediateProcessingResult ProcessIntermediateDocs(EKantanDocGenConverter Converter, FString const& IntermediateDir, FString const& OutputDir, FString const& DocTitle, bool bCleanOutput, bool bSkipUnchangedNodes = false);
+	static int32 RunExternalConversionTool(FString const& IntermediateDir, FString const& OutputDir, FString const& DocTitle, bool bCleanOutput);
 
 protected:
 	TQueue< TSharedPtr< FDocGenTask > > Waiting;
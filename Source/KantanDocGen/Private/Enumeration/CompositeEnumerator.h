@@ -9,19 +9,24 @@
 #include "ISourceObjectEnumerator.h"
 
 
+/*
+Enumerates through a child enumerator per name in turn. Any additional constructor arguments are passed on to each child.
+*/
 template < typename TChildEnum >
 class FCompositeEnumerator: public ISourceObjectEnumerator
 {
 public:
+	template < typename... TArgs >
 	FCompositeEnumerator(
-		TArray< FName > const& InNames
+		TArray< FName > const& InNames,
+		TArgs const&... InArgs
 	)
 	{
 		CurEnumIndex = 0;
 		TotalSize = 0;
 		Completed = 0;
 
-		Prepass(InNames);
+		Prepass(InNames, InArgs...);
 	}
 
 public:
@@ -63,11 +68,12 @@ public:
 	}
 
 protected:
-	void Prepass(TArray< FName > const& Names)
+	template < typename... TArgs >
+	void Prepass(TArray< FName > const& Names, TArgs const&... Args)
 	{
 		for(auto Name : Names)
 		{
-			auto Child = MakeUnique< TChildEnum >(Name);
+			auto Child = MakeUnique< TChildEnum >(Name, Args...);
 			TotalSize += Child->EstimatedSize();
 
 			ChildEnumList.Add(MoveTemp(Child));
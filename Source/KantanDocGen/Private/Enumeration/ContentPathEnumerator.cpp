@@ -10,18 +10,41 @@
 #include "ARFilter.h"
 #include "Engine/Blueprint.h"
 #include "Animation/AnimBlueprint.h"
+#include "Engine/StreamableManager.h"
+#include "DocGenExclusionRules.h"
 
 
 FContentPathEnumerator::FContentPathEnumerator(
-	FName const& InPath
+	FName const& InPath,
+	int32 InPrefetchCount,
+	FDocGenExclusionRules const* InExclusions
 )
 {
 	CurIndex = 0;
+	PrefetchCount = FMath::Max(InPrefetchCount, 0);
 
-	Prepass(InPath);
+	Prepass(InPath, InExclusions);
+
+	if(PrefetchCount > 0)
+	{
+		StreamableManager = MakeUnique< FStreamableManager >();
+	}
 }
 
-void FContentPathEnumerator::Prepass(FName const& Path)
+FContentPathEnumerator::~FContentPathEnumerator()
+{
+	for(auto& Handle : PrefetchHandles)
+	{
+		if(Handle.IsValid())
+		{
+			Handle->CancelHandle();
+		}
+	}
+	PrefetchHandles.Empty();
+	CurrentHandle.Reset();
+}
+
+void FContentPathEnumerator::Prepass(FName const& Path, FDocGenExclusionRules const* Exclusions)
 {
 	auto& AssetRegistryModule = FModuleManager::GetModuleChecked< FAssetRegistryModule >("AssetRegistry");
 	auto& AssetRegistry = AssetRegistryModule.Get();
@@ -35,6 +58,37 @@ void FContentPathEnumerator::Prepass(FName const& Path)
 
 	AssetRegistry.GetAssetsByPath(Path, AssetList, true);
 	AssetRegistry.RunAssetsThroughFilter(AssetList, Filter);
+
+	// Reject anything we can tell from its tags won't produce docs, or that is excluded, so it never gets loaded
+	int32 const NumBlueprints = AssetList.Num();
+	AssetList.RemoveAll([Exclusions](FAssetData const& AssetData)
+	{
+		return !CanProduceDocs(AssetData) || (Exclusions && Exclusions->IsBlueprintAssetExcluded(AssetData));
+	});
+
+	UE_LOG(LogKantanDocGen, Log, TEXT("Content path '%s' has %i blueprints, %i skipped based on asset registry tags or exclusions."), *Path.ToString(), AssetList.Num(), NumBlueprints - AssetList.Num());
+}
+
+bool FContentPathEnumerator::CanProduceDocs(FAssetData const& AssetData)
+{
+	// Blueprints saved before these tags existed won't have them, so are given the benefit of the doubt
+	FString TagValue;
+	if(AssetData.GetTagValue(FBlueprintTags::BlueprintType, TagValue))
+	{
+		// Level scripts have no actions usable from other blueprints
+		if(TagValue == TEXT("BPTYPE_LevelScript"))
+		{
+			return false;
+		}
+	}
+
+	// Data only blueprints add no functions, events or macros, and their variables aren't documented
+	if(AssetData.GetTagValue(FBlueprintTags::IsDataOnly, TagValue) && TagValue.ToBool())
+	{
+		return false;
+	}
+
+	return true;
 }
 
 UObject* FContentPathEnumerator::GetNext()
@@ -44,9 +98,10 @@ UObject* FContentPathEnumerator::GetNext()
 	while(CurIndex < AssetList.Num())
 	{
 		auto const& AssetData = AssetList[CurIndex];
+		auto Asset = LoadAsset(CurIndex);
 		++CurIndex;
 
-		if(auto Blueprint = Cast< UBlueprint >(AssetData.GetAsset()))
+		if(auto Blueprint = Cast< UBlueprint >(Asset))
 		{
 			UE_LOG(LogKantanDocGen, Log, TEXT("Enumerating object '%s' at '%s'"), *Blueprint->GetName(), *AssetData.ObjectPath.ToString());
 
@@ -58,6 +113,47 @@ UObject* FContentPathEnumerator::GetNext()
 	return Result;
 }
 
+void FContentPathEnumerator::UpdatePrefetch()
+{
+	// Keep the window topped up with requests for the assets following the current one
+	int32 const WindowEnd = FMath::Min(CurIndex + PrefetchCount, AssetList.Num());
+	for(int32 Idx = CurIndex + PrefetchHandles.Num(); Idx < WindowEnd; ++Idx)
+	{
+		PrefetchHandles.Add(StreamableManager->RequestAsyncLoad(AssetList[Idx].ToSoftObjectPath()));
+	}
+}
+
+UObject* FContentPathEnumerator::LoadAsset(int32 Index)
+{
+	check(Index == CurIndex);
+
+	// The previous asset is done with
+	CurrentHandle.Reset();
+
+	if(!StreamableManager.IsValid())
+	{
+		return AssetList[Index].GetAsset();
+	}
+
+	UpdatePrefetch();
+
+	CurrentHandle = PrefetchHandles[0];
+	PrefetchHandles.RemoveAt(0, 1, false);
+
+	if(CurrentHandle.IsValid())
+	{
+		// Will usually have completed already while earlier assets were being documented
+		CurrentHandle->WaitUntilComplete();
+		if(auto Asset = CurrentHandle->GetLoadedAsset())
+		{
+			return Asset;
+		}
+	}
+
+	// Fall back on a synchronous load
+	return AssetList[Index].GetAsset();
+}
+
 float FContentPathEnumerator::EstimateProgress() const
 {
 	return (float)CurIndex / (AssetList.Num() - 1);
@@ -10,12 +10,23 @@
 #include "AssetData.h"
 
 
+struct FStreamableManager;
+struct FStreamableHandle;
+class FDocGenExclusionRules;
+
+/*
+Enumerates blueprints under a content path.
+Optionally streams in a window of upcoming blueprints asynchronously, so their loads overlap with documenting earlier ones.
+*/
 class FContentPathEnumerator: public ISourceObjectEnumerator
 {
 public:
 	FContentPathEnumerator(
-		FName const& InPath
+		FName const& InPath,
+		int32 InPrefetchCount = 0,
+		FDocGenExclusionRules const* InExclusions = nullptr
 	);
+	virtual ~FContentPathEnumerator();
 
 public:
 	virtual UObject* GetNext() override;
@@ -23,11 +34,22 @@ public:
 	virtual int32 EstimatedSize() const override;
 
 protected:
-	void Prepass(FName const& Path);
+	void Prepass(FName const& Path, FDocGenExclusionRules const* Exclusions);
+	/** Whether a blueprint may have documentable actions, judged only from its asset registry tags. */
+	static bool CanProduceDocs(FAssetData const& AssetData);
+	void UpdatePrefetch();
+	UObject* LoadAsset(int32 Index);
 
 protected:
 	TArray< FAssetData > AssetList;
 	int32 CurIndex;
+
+	int32 PrefetchCount;
+	// Async load requests for assets from CurIndex onwards
+	TArray< TSharedPtr< FStreamableHandle > > PrefetchHandles;
+	// Keeps the most recently enumerated asset loaded while it's being documented
+	TSharedPtr< FStreamableHandle > CurrentHandle;
+	TUniquePtr< FStreamableManager > StreamableManager;
 };
 
 
@@ -9,18 +9,20 @@
 #include "UObject/UnrealType.h"
 #include "UObject/Package.h"
 #include "UObject/UObjectHash.h"
+#include "DocGenExclusionRules.h"
 
 
 FNativeModuleEnumerator::FNativeModuleEnumerator(
-	FName const& InModuleName
+	FName const& InModuleName,
+	FDocGenExclusionRules const* InExclusions
 )
 {
 	CurIndex = 0;
 
-	Prepass(InModuleName);
+	Prepass(InModuleName, InExclusions);
 }
 
-void FNativeModuleEnumerator::Prepass(FName const& ModuleName)
+void FNativeModuleEnumerator::Prepass(FName const& ModuleName, FDocGenExclusionRules const* Exclusions)
 {
 	// For native package, all classes are already loaded so it's no problem to fully enumerate during prepass.
 	// That way we have more info for progress estimation.
@@ -45,6 +47,7 @@ void FNativeModuleEnumerator::Prepass(FName const& ModuleName)
 
 	// @TODO: Work out why the below enumeration is called twice for every class in the package (it's called on the exact same uclass instance)
 	TSet< UObject* > Processed;
+	int32 ExcludedCount = 0;
 
 	// Functor to invoke on every object found in the package
 	TFunction< void(UObject*) > ObjectEnumFtr = [&](UObject* Obj)
@@ -57,13 +60,21 @@ void FNativeModuleEnumerator::Prepass(FName const& ModuleName)
 		// Native class?
 		if(auto Class = Cast< UClass >(Obj))
 		{
-			if(Class->HasAllClassFlags(CLASS_Native) && !Class->HasAnyFlags(RF_ClassDefaultObject))
+			if(Class->HasAllClassFlags(CLASS_Native) && !Class->HasAnyFlags(RF_ClassDefaultObject) && !Processed.Contains(Class))
 			{
-				ObjectToProcess = Class;
+				if(Exclusions && Exclusions->IsClassExcluded(Class))
+				{
+					++ExcludedCount;
+					Processed.Add(Class);
+				}
+				else
+				{
+					ObjectToProcess = Class;
+				}
 			}
 		}
 
-		if(ObjectToProcess && !Processed.Contains(ObjectToProcess))
+		if(ObjectToProcess)
 		{
 			UE_LOG(LogKantanDocGen, Log, TEXT("Enumerating object '%s' in package '%s'"), *ObjectToProcess->GetName(), *PkgName);
 
@@ -74,8 +85,13 @@ void FNativeModuleEnumerator::Prepass(FName const& ModuleName)
 		}
 	};
 
-	// Enumerate all objects in the package
-	ForEachObjectWithOuter(Package, ObjectEnumFtr, true /* Include nested */);
+	// Native classes are outered directly to their package, no need to visit every function and property nested in them
+	ForEachObjectWithOuter(Package, ObjectEnumFtr, false /* Include nested */);
+
+	if(ExcludedCount > 0)
+	{
+		UE_LOG(LogKantanDocGen, Log, TEXT("Excluded %i classes in package '%s'."), ExcludedCount, *PkgName);
+	}
 }
 
 UObject* FNativeModuleEnumerator::GetNext()
@@ -9,11 +9,14 @@
 #include "ISourceObjectEnumerator.h"
 
 
+class FDocGenExclusionRules;
+
 class FNativeModuleEnumerator: public ISourceObjectEnumerator
 {
 public:
 	FNativeModuleEnumerator(
-		FName const& InModuleName
+		FName const& InModuleName,
+		FDocGenExclusionRules const* InExclusions = nullptr
 	);
 
 public:
@@ -22,7 +25,7 @@ public:
 	virtual int32 EstimatedSize() const override;
 
 protected:
-	void Prepass(FName const& ModuleName);
+	void Prepass(FName const& ModuleName, FDocGenExclusionRules const* Exclusions);
 
 protected:
 	TArray< TWeakObjectPtr< UObject > > ObjectList;
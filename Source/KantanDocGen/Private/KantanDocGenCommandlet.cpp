@@ -0,0 +1,142 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#include "KantanDocGenCommandlet.h"
+#include "KantanDocGenLog.h"
+#include "DocGenSettings.h"
+#include "DocGenTaskProcessor.h"
+#include "AssetRegistryModule.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Misc/Paths.h"
+#include "Misc/Parse.h"
+
+
+namespace KantanDocGenExitCodes
+{
+	enum Type: int32
+	{
+		Success = 0,
+		InvalidArguments = 1,
+		GenerationFailed = 2,
+		NoNodes = 3,
+		ConversionFailed = 4,
+		DiskWriteFailure = 5,
+		Cancelled = 6,
+	};
+}
+
+
+UKantanDocGenCommandlet::UKantanDocGenCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Generates Blueprint node documentation without the editor UI.");
+	HelpUsage = TEXT("-run=KantanDocGen [-Config=<IniFile>] [-<Setting>=<Value>] [-<bBoolSetting>] [-NoImages]");
+	HelpParamNames.Add(TEXT("Config"));
+	HelpParamDescriptions.Add(TEXT("Ini file to load settings from, in the same format as the editor saves them."));
+	HelpParamNames.Add(TEXT("<Setting>"));
+	HelpParamDescriptions.Add(TEXT("Any documentation setting by property name, in text export format, e.g. -DocumentationTitle=MyDocs -NativeModules=(MyModule,MyOtherModule)."));
+	HelpParamNames.Add(TEXT("NoImages"));
+	HelpParamDescriptions.Add(TEXT("Generate text only docs, without rendering any node images."));
+}
+
+int32 UKantanDocGenCommandlet::Main(FString const& Params)
+{
+	auto SettingsObject = UKantanDocGenSettingsObject::Get();
+
+	FString ConfigFile;
+	if(FParse::Value(*Params, TEXT("Config="), ConfigFile))
+	{
+		ConfigFile = FPaths::ConvertRelativePathToFull(ConfigFile);
+		if(!FPaths::FileExists(ConfigFile))
+		{
+			UE_LOG(LogKantanDocGen, Error, TEXT("Config file '%s' not found."), *ConfigFile);
+			return KantanDocGenExitCodes::InvalidArguments;
+		}
+
+		SettingsObject->LoadConfig(nullptr, *ConfigFile);
+	}
+
+	FKantanDocGenSettings Settings = SettingsObject->Settings;
+	if(!ApplyCommandLineSettings(Params, Settings))
+	{
+		return KantanDocGenExitCodes::InvalidArguments;
+	}
+
+	if(FParse::Param(*Params, TEXT("NoImages")))
+	{
+		Settings.bGenerateImages = false;
+	}
+
+	if(Settings.bGenerateImages && !FSlateApplication::IsInitialized())
+	{
+		UE_LOG(LogKantanDocGen, Warning, TEXT("Node images require a renderer, which is not available. Generating text only docs."));
+		Settings.bGenerateImages = false;
+	}
+
+	if(!Settings.HasAnySources())
+	{
+		UE_LOG(LogKantanDocGen, Error, TEXT("No native modules or content paths specified to document."));
+		return KantanDocGenExitCodes::InvalidArguments;
+	}
+
+	if(Settings.ContentPaths.Num() > 0)
+	{
+		// Content enumeration relies on the asset registry, which won't have finished its initial scan
+		auto& AssetRegistryModule = FModuleManager::LoadModuleChecked< FAssetRegistryModule >("AssetRegistry");
+		AssetRegistryModule.Get().SearchAllAssets(true);
+	}
+
+	UE_LOG(LogKantanDocGen, Display, TEXT("Generating docs '%s' to '%s'."), *Settings.DocumentationTitle, *Settings.OutputDirectory.Path);
+
+	FDocGenTaskProcessor Processor;
+	switch(Processor.RunTaskSynchronous(Settings))
+	{
+		case FDocGenTaskProcessor::EDocGenResult::Success:
+		return KantanDocGenExitCodes::Success;
+		case FDocGenTaskProcessor::EDocGenResult::NoNodes:
+		return KantanDocGenExitCodes::NoNodes;
+		case FDocGenTaskProcessor::EDocGenResult::ConversionFailed:
+		return KantanDocGenExitCodes::ConversionFailed;
+		case FDocGenTaskProcessor::EDocGenResult::DiskWriteFailure:
+		return KantanDocGenExitCodes::DiskWriteFailure;
+		case FDocGenTaskProcessor::EDocGenResult::Cancelled:
+		return KantanDocGenExitCodes::Cancelled;
+		default:
+		return KantanDocGenExitCodes::GenerationFailed;
+	}
+}
+
+bool UKantanDocGenCommandlet::ApplyCommandLineSettings(FString const& Params, FKantanDocGenSettings& Settings)
+{
+	for(TFieldIterator< FProperty > It(FKantanDocGenSettings::StaticStruct()); It; ++It)
+	{
+		auto Prop = *It;
+		auto const Name = Prop->GetName();
+		auto ValuePtr = Prop->ContainerPtrToValuePtr< void >(&Settings);
+
+		FString Value;
+		if(FParse::Value(*Params, *(Name + TEXT("=")), Value, false))
+		{
+			if(Prop->ImportText(*Value, ValuePtr, PPF_None, nullptr) == nullptr)
+			{
+				UE_LOG(LogKantanDocGen, Error, TEXT("Invalid value '%s' for setting '%s'."), *Value, *Name);
+				return false;
+			}
+		}
+		else if(Prop->IsA< FBoolProperty >() && FParse::Param(*Params, *Name))
+		{
+			// Bool settings can also be enabled with a plain switch
+			CastFieldChecked< FBoolProperty >(Prop)->SetPropertyValue(ValuePtr, true);
+		}
+	}
+
+	return true;
+}
+
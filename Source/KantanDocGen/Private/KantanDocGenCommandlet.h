@@ -0,0 +1,35 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "KantanDocGenCommandlet.generated.h"
+
+
+struct FKantanDocGenSettings;
+
+/*
+Headless doc generation, for use from build machines.
+Usage: UE4Editor-Cmd <Project> -run=KantanDocGen [-Config=<IniFile>] [-<Setting>=<Value>] [-<bBoolSetting>] [-NoImages]
+Settings start from those saved from the editor UI, optionally overridden by an ini file and then individual arguments.
+*/
+UCLASS()
+class UKantanDocGenCommandlet: public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UKantanDocGenCommandlet();
+
+public:
+	virtual int32 Main(FString const& Params) override;
+
+protected:
+	/** Overrides any settings specified by name on the command line. Returns false if a value couldn't be parsed. */
+	static bool ApplyCommandLineSettings(FString const& Params, FKantanDocGenSettings& Settings);
+};
+
@@ -9,6 +9,7 @@
 #include "KantanDocGenCommands.h"
 #include "DocGenSettings.h"
 #include "DocGenTaskProcessor.h"
+#include "NodeDocsGenerator.h"
 #include "UI/SKantanDocGenWidget.h"
 
 #include "HAL/IConsoleManager.h"
@@ -17,6 +18,7 @@
 #include "Framework/MultiBox/MultiBoxBuilder.h"
 #include "Framework/Application/SlateApplication.h"
 #include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
 
 #define LOCTEXT_NAMESPACE "KantanDocGen"
 
@@ -83,6 +85,47 @@ inline bool MatchPotentiallyQuoted(const TCHAR* Stream, const TCHAR* Match, FStr
 	return false;
 }
 
+static void BenchmarkConversion(TArray< FString > const& Args)
+{
+	if(Args.Num() < 1)
+	{
+		UE_LOG(LogKantanDocGen, Warning, TEXT("Usage: KantanDocGen.BenchmarkConversion <DocumentationTitle> [Iterations]"));
+		return;
+	}
+
+	FString const& DocTitle = Args[0];
+	int32 const Iterations = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1;
+
+	FDocGenTaskProcessor::BenchmarkConversion(
+		FPaths::ProjectIntermediateDir() / TEXT("KantanDocGen") / DocTitle,
+		FPaths::ProjectSavedDir() / TEXT("KantanDocGen") / TEXT("Benchmark"),
+		DocTitle,
+		Iterations
+	);
+}
+
+static FAutoConsoleCommand BenchmarkConversionCommand(
+	TEXT("KantanDocGen.BenchmarkConversion"),
+	TEXT("Converts the intermediate docs from a previous run with both the native and external converters, and logs the time taken by each."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkConversion)
+);
+
+static void BenchmarkXmlSerialization(TArray< FString > const& Args)
+{
+	int32 const Iterations = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000;
+
+	FNodeDocsGenerator::BenchmarkXmlSerialization(
+		FPaths::ProjectSavedDir() / TEXT("KantanDocGen") / TEXT("Benchmark"),
+		Iterations
+	);
+}
+
+static FAutoConsoleCommand BenchmarkXmlSerializationCommand(
+	TEXT("KantanDocGen.BenchmarkXml"),
+	TEXT("Times serialization of a node doc with FXmlFile and with the streaming xml writer."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkXmlSerialization)
+);
+
 void FKantanDocGenModule::GenerateDocs(FKantanDocGenSettings const& Settings)
 {
 	if(!Processor.IsValid())
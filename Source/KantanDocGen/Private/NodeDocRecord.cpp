@@ -0,0 +1,102 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#include "NodeDocRecord.h"
+#include "Misc/ScopeLock.h"
+#include "EdGraphSchema_K2.h"
+#include "UObject/Class.h"
+
+
+FDocGenStringTable::FDocGenStringTable()
+{
+	Reset();
+}
+
+FString const* FDocGenStringTable::Intern(FString&& Str)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	if(auto Existing = Lookup.Find(&Str))
+	{
+		return *Existing;
+	}
+
+	Storage.Add(MakeUnique< FString >(MoveTemp(Str)));
+	FString const* Interned = Storage.Last().Get();
+	Lookup.Add(Interned);
+	return Interned;
+}
+
+int32 FDocGenStringTable::Num() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Storage.Num();
+}
+
+void FDocGenStringTable::Reset()
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		Lookup.Empty();
+		Storage.Empty();
+	}
+
+	EmptyString = Intern(FString());
+}
+
+
+uint32 FDocGenPinTextTable::FPinTypeKeyFuncs::GetKeyHash(KeyInitType Key)
+{
+	// Covers the members which vary in practice, the rest are left to Matches
+	uint32 Hash = HashCombine(GetTypeHash(Key.PinCategory), GetTypeHash(Key.PinSubCategory));
+	Hash = HashCombine(Hash, GetTypeHash(Key.PinSubCategoryObject));
+	Hash = HashCombine(Hash, GetTypeHash(Key.PinValueType.TerminalCategory));
+	Hash = HashCombine(Hash, GetTypeHash(Key.PinValueType.TerminalSubCategoryObject));
+	Hash = HashCombine(Hash, (uint32)Key.ContainerType | ((uint32)Key.bIsReference << 8) | ((uint32)Key.bIsConst << 9));
+	return Hash;
+}
+
+FString const* FDocGenPinTextTable::GetTypeText(FEdGraphPinType const& PinType)
+{
+	check(IsInGameThread());
+
+	if(auto Existing = TypeTexts.Find(PinType))
+	{
+		return *Existing;
+	}
+
+	FString const* Text = Strings.Intern(UEdGraphSchema_K2::TypeToText(PinType).ToString());
+	TypeTexts.Add(PinType, Text);
+	return Text;
+}
+
+FString const* FDocGenPinTextTable::FindParamDescription(UFunction* Func, FName ParamName) const
+{
+	check(IsInGameThread());
+
+	auto Existing = ParamDescriptions.Find(FParamKey(Func, ParamName));
+	return Existing ? *Existing : nullptr;
+}
+
+FString const* FDocGenPinTextTable::AddParamDescription(UFunction* Func, FName ParamName, FString&& Description)
+{
+	check(IsInGameThread());
+
+	FString const* Text = Strings.Intern(MoveTemp(Description));
+	ParamDescriptions.Add(FParamKey(Func, ParamName), Text);
+	return Text;
+}
+
+int32 FDocGenPinTextTable::NumTypes() const
+{
+	return TypeTexts.Num();
+}
+
+void FDocGenPinTextTable::Reset()
+{
+	TypeTexts.Empty();
+	ParamDescriptions.Empty();
+}
@@ -0,0 +1,104 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/Crc.h"
+#include "EdGraph/EdGraphPin.h"
+#include "Output/DocGenContent.h"
+
+
+/*
+Run-wide table of interned strings. Each distinct string is stored once, at an address which remains valid for the
+lifetime of the table, so interned strings can be held and compared by pointer.
+Safe to use concurrently from any thread.
+*/
+class FDocGenStringTable
+{
+public:
+	FDocGenStringTable();
+
+public:
+	FString const* Intern(FString&& Str);
+	FString const* Intern(FString const& Str)
+	{
+		return Intern(FString(Str));
+	}
+	/** Always valid empty string. */
+	FString const* Empty() const { return EmptyString; }
+
+	int32 Num() const;
+	void Reset();
+
+protected:
+	struct FKeyFuncs: BaseKeyFuncs< FString const*, FString const*, false >
+	{
+		static KeyInitType GetSetKey(ElementInitType Element) { return Element; }
+		static bool Matches(KeyInitType A, KeyInitType B) { return A->Equals(*B, ESearchCase::CaseSensitive); }
+		static uint32 GetKeyHash(KeyInitType Key) { return FCrc::StrCrc32(**Key); }
+	};
+
+	TSet< FString const*, FKeyFuncs > Lookup;
+	TArray< TUniquePtr< FString > > Storage;
+	FString const* EmptyString;
+	mutable FCriticalSection Lock;
+};
+
+
+/*
+Text describing pins, computed once for each distinct pin type and function param and interned for the rest of the run.
+Computing the text means looking at UObjects and FText, so this is game thread only. Workers just get the interned strings.
+*/
+class FDocGenPinTextTable
+{
+public:
+	explicit FDocGenPinTextTable(FDocGenStringTable& InStrings):
+		Strings(InStrings)
+	{}
+
+public:
+	FString const* GetTypeText(FEdGraphPinType const& PinType);
+	/** Null if no description has been added for the param. */
+	FString const* FindParamDescription(UFunction* Func, FName ParamName) const;
+	FString const* AddParamDescription(UFunction* Func, FName ParamName, FString&& Description);
+
+	int32 NumTypes() const;
+	void Reset();
+
+protected:
+	struct FPinTypeKeyFuncs: TDefaultMapKeyFuncs< FEdGraphPinType, FString const*, false >
+	{
+		static bool Matches(KeyInitType A, KeyInitType B) { return A == B; }
+		static uint32 GetKeyHash(KeyInitType Key);
+	};
+
+	// Weak, since blueprint functions may be collected and their addresses reused during the run
+	typedef TPair< TWeakObjectPtr< UFunction >, FName > FParamKey;
+
+	FDocGenStringTable& Strings;
+	TMap< FEdGraphPinType, FString const*, FDefaultSetAllocator, FPinTypeKeyFuncs > TypeTexts;
+	TMap< FParamKey, FString const* > ParamDescriptions;
+};
+
+/*
+Everything the docs need from a spawned node, captured on the game thread so that the node can be released immediately.
+Strings are interned in the generator's string table, so this is cheap to copy and safe to consume from any thread.
+*/
+struct FNodeDocRecord
+{
+	FString const* Id = nullptr;
+	FString const* ShortTitle = nullptr;
+	FString const* FullTitle = nullptr;
+	FString const* Description = nullptr;
+	FString const* Category = nullptr;
+	TArray< FDocGenParamRef > Inputs;
+	TArray< FDocGenParamRef > Outputs;
+
+	bool IsValid() const { return Id != nullptr; }
+};
+
@@ -12,34 +12,74 @@
 #include "SGraphPanel.h"
 #include "NodeFactory.h"
 #include "EdGraphSchema_K2.h"
+#include "K2Node_CallFunction.h"
+#include "BlueprintFunctionNodeSpawner.h"
+#include "UObject/MetaData.h"
 #include "Kismet2/BlueprintEditorUtils.h"
 #include "Kismet2/KismetEditorUtilities.h"
 #include "BlueprintActionDatabase.h"
 #include "BlueprintNodeSpawner.h"
-#include "BlueprintFunctionNodeSpawner.h"
-#include "BlueprintBoundNodeSpawner.h"
-#include "BlueprintComponentNodeSpawner.h"
-#include "BlueprintEventNodeSpawner.h"
-#include "K2Node_DynamicCast.h"
-#include "K2Node_Message.h"
 #include "HighResScreenshot.h"
 #include "XmlFile.h"
+#include "Output/DocGenXmlWriter.h"
+#include "Output/IntermediateDocReader.h"
 #include "Slate/WidgetRenderer.h"
+#include "Widgets/SCanvas.h"
+#include "NodeRenderPool.h"
+#include "RenderingThread.h"
+#include "RHICommandList.h"
+#include "RHI.h"
 #include "Engine/TextureRenderTarget2D.h"
 #include "TextureResource.h"
 #include "ThreadingHelpers.h"
 #include "Stats/StatsMisc.h"
+#include "Misc/ScopeLock.h"
 #include "Runtime/ImageWriteQueue/Public/ImageWriteTask.h"
+#include "Runtime/ImageWriteQueue/Public/ImageWriteQueue.h"
+#include "Output/HtmlDocRenderer.h"
+#include "DocGenManifest.h"
+#include "DocGenImageCache.h"
+#include "Misc/SecureHash.h"
+#include "Misc/EngineVersion.h"
+#include "HAL/FileManager.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Crc.h"
+
+
+/* Like SCOPE_SECONDS_COUNTER, but for a counter which is added to from several threads at once. */
+struct FScopeSharedSecondsCounter
+{
+	FScopeSharedSecondsCounter(double& InCounter, FCriticalSection& InLock):
+		Counter(InCounter)
+		, Lock(InLock)
+		, StartTime(FPlatformTime::Seconds())
+	{}
+
+	~FScopeSharedSecondsCounter()
+	{
+		double const Elapsed = FPlatformTime::Seconds() - StartTime;
+		FScopeLock ScopeLock(&Lock);
+		Counter += Elapsed;
+	}
+
+	double& Counter;
+	FCriticalSection& Lock;
+	double StartTime;
+};
 
 FNodeDocsGenerator::~FNodeDocsGenerator()
 {
 	CleanUp();
 }
 
-bool FNodeDocsGenerator::GT_Init(FString const& InDocsTitle, FString const& InOutputDir, UClass* BlueprintContextClass)
+bool FNodeDocsGenerator::GT_Init(FKantanDocGenSettings const& InSettings, FString const& InOutputDir, FDocGenManifest* InManifest)
 {
+	Settings = InSettings;
+	Manifest = InManifest;
+	SettingsHash = FDocGenManifest::HashSettings(Settings);
+
 	DummyBP = CastChecked< UBlueprint >(FKismetEditorUtilities::CreateBlueprint(
-		BlueprintContextClass,
+		Settings.BlueprintContextClass,
 		::GetTransientPackage(),
 		NAME_None,
 		EBlueprintType::BPTYPE_Normal,
@@ -52,32 +92,66 @@ bool FNodeDocsGenerator::GT_Init(FString const& InDocsTitle, FString const& InOu
 		return false;
 	}
 
-	Graph = FBlueprintEditorUtils::CreateNewGraph(DummyBP.Get(), TEXT("TempoGraph"), UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass());
-
 	DummyBP->AddToRoot();
-	Graph->AddToRoot();
 
-	GraphPanel = SNew(SGraphPanel)
-		.GraphObj(Graph.Get())
-		;
-	// We want full detail for rendering, passing a super-high zoom value will guarantee the highest LOD.
-	GraphPanel->RestoreViewSettings(FVector2D(0, 0), 10.0f);
+	LiveNodeCounts.Empty();
+	GraphRecycleInterval = FMath::Max(Settings.GraphRecycleInterval, 1);
+	GT_RotateGraph();
 
-	DocsTitle = InDocsTitle;
+	DocsTitle = Settings.DocumentationTitle;
 
-	IndexXml = InitIndexXml(DocsTitle);
+	IndexDoc = FDocGenIndexContent();
+	IndexDoc.DisplayName = DocsTitle;
+	PinTexts.Reset();
+	Strings.Reset();
 	ClassDocsMap.Empty();
+	LateClassDocs.Empty();
+	FlushedClasses.Empty();
+	bClassDocWriteFailed = false;
+	DocumentedNodes.Empty();
+	ClaimedNodeIds.Empty();
+	DuplicateNodeCount = 0;
+	NodeIdCollisionCount = 0;
 
 	OutputDir = InOutputDir;
 
+	bAsyncReadback = Settings.bAsyncReadback && !GUsingNullRHI;
+	if(Settings.bAsyncReadback && !bAsyncReadback)
+	{
+		UE_LOG(LogKantanDocGen, Log, TEXT("Async readback is unavailable with the null RHI, node images will be read back synchronously."));
+	}
+	MaxPendingReadbacks = FMath::Max(Settings.ReadbackRingSize, 1);
+
+	ImageWriteQueue = &FModuleManager::LoadModuleChecked< IImageWriteQueueModule >("ImageWriteQueue").GetWriteQueue();
+	MaxPendingImageWrites = FMath::Max(Settings.MaxPendingImageWrites, 1);
+
+	ImageCache.Reset();
+	if(Settings.bUseImageCache && Settings.bGenerateImages)
+	{
+		ImageCache = MakeUnique< FDocGenImageCache >();
+	}
+	ImageCacheHits.Reset();
+
+	PendingImageWrites.Empty();
+	FailedImageWrites.Reset();
+
 	return true;
 }
 
 UK2Node* FNodeDocsGenerator::GT_InitializeForSpawner(UBlueprintNodeSpawner* Spawner, UObject* SourceObject, FNodeProcessingState& OutState)
 {
-	if(!IsSpawnerDocumentable(Spawner, SourceObject->IsA< UBlueprint >()))
+	// Plain function calls can be identified without spawning anything
+	FString Identity;
+	auto FuncSpawner = Cast< UBlueprintFunctionNodeSpawner >(Spawner);
+	if(FuncSpawner && FuncSpawner->NodeClass == UK2Node_CallFunction::StaticClass() && FuncSpawner->GetFunction())
 	{
-		return nullptr;
+		auto Func = FuncSpawner->GetFunction();
+		Identity = ComputeFunctionIdentity(Func);
+		if(GT_IsNodeDocumented(GetClassDocId(Func->GetOwnerClass()), Identity))
+		{
+			++DuplicateNodeCount;
+			return nullptr;
+		}
 	}
 
 	// Spawn an instance into the graph
@@ -88,505 +162,1675 @@ UK2Node* FNodeDocsGenerator::GT_InitializeForSpawner(UBlueprintNodeSpawner* Spaw
 
 	if(K2NodeInst == nullptr)
 	{
+		if(NodeInst)
+		{
+			Graph->Nodes.RemoveSwap(NodeInst);
+		}
+
 		UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to create node from spawner of class %s with node class %s."), *Spawner->GetClass()->GetName(), Spawner->NodeClass ? *Spawner->NodeClass->GetName() : TEXT("None"));
 		return nullptr;
 	}
 
+	// Make sure this node object will never be GCd until we're done with it.
+	K2NodeInst->AddToRoot();
+	++LiveNodeCounts.FindOrAdd(Graph.Get());
+	++GraphSpawnCount;
+
 	auto AssociatedClass = MapToAssociatedClass(K2NodeInst, SourceObject);
+	if(Identity.IsEmpty())
+	{
+		Identity = ComputeNodeIdentity(K2NodeInst);
+		if(GT_IsNodeDocumented(GetClassDocId(AssociatedClass), Identity))
+		{
+			++DuplicateNodeCount;
+			GT_ReleaseNodes({ K2NodeInst });
+			return nullptr;
+		}
+	}
+
+	InitNodeState(AssociatedClass, OutState);
+	GT_CaptureNodeRecord(K2NodeInst, GT_ClaimNodeId(OutState, Identity, GetNodeDocId(K2NodeInst)), OutState.Record);
 
-	if(!ClassDocsMap.Contains(AssociatedClass))
+	if(Manifest)
 	{
-		// New class xml file needs adding
-		ClassDocsMap.Add(AssociatedClass, InitClassDocXml(AssociatedClass));
-		// Also update the index xml
-		UpdateIndexDocWithClass(IndexXml.Get(), AssociatedClass);
+		auto const& NodeId = *OutState.Record.Id;
+		auto const Signature = ComputeNodeSignature(K2NodeInst, Spawner, SettingsHash);
+		OutState.bUpToDate = Manifest->Update(FDocGenManifest::MakeNodeKey(OutState.ClassId, NodeId), Signature)
+			&& HasNodeArtifacts(OutState, NodeId);
+
+		if(OutState.bUpToDate && OutState.bGenerateImage)
+		{
+			OutState.RelImageBasePath = TEXT("../img");
+			OutState.ImageFilename = GetNodeImageFilename(NodeId);
+		}
+	}
+
+	if(ImageCache.IsValid() && OutState.NeedsImageCapture())
+	{
+		OutState.ImageCacheKey = ComputeNodeVisualKey(K2NodeInst);
+		OutState.bImageCached = ImageCache->Contains(OutState.ImageCacheKey);
 	}
-	
-	OutState = FNodeProcessingState();
-	OutState.ClassDocXml = ClassDocsMap.FindChecked(AssociatedClass);
-	OutState.ClassDocsPath = OutputDir / GetClassDocId(AssociatedClass);
 
 	return K2NodeInst;
 }
 
-bool FNodeDocsGenerator::GT_Finalize(FString OutputPath)
+bool FNodeDocsGenerator::CanDocumentByReflection(UBlueprintNodeSpawner* Spawner) const
 {
-	if(!SaveClassDocXml(OutputPath))
+	// Images can only be had by spawning and rendering a node
+	if(!Settings.bReflectionFastPath || Settings.bGenerateImages)
 	{
 		return false;
 	}
 
-	if(!SaveIndexXml(OutputPath))
+	// Only plain function calls, subclasses customize their pins and titles
+	auto FuncSpawner = Cast< UBlueprintFunctionNodeSpawner >(Spawner);
+	if(FuncSpawner == nullptr || FuncSpawner->NodeClass != UK2Node_CallFunction::StaticClass())
 	{
 		return false;
 	}
 
-	return true;
+	// Enum expansion replaces params with exec pins, which only the node knows how to do
+	auto Func = FuncSpawner->GetFunction();
+	return Func && Func->HasAnyFunctionFlags(FUNC_Native) && !Func->HasMetaData(FBlueprintMetadata::MD_ExpandEnumAsExecs);
 }
 
-void FNodeDocsGenerator::CleanUp()
+bool FNodeDocsGenerator::GT_InitializeForFunction(UBlueprintNodeSpawner* Spawner, FNodeProcessingState& OutState)
 {
-	if(GraphPanel.IsValid())
-	{
-		GraphPanel.Reset();
-	}
+	auto Func = CastChecked< UBlueprintFunctionNodeSpawner >(Spawner)->GetFunction();
 
-	if(DummyBP.IsValid())
+	// Same identity as a spawned node for the function would have, so the two paths dedup against each other
+	FString const Identity = ComputeFunctionIdentity(Func);
+	if(GT_IsNodeDocumented(GetClassDocId(Func->GetOwnerClass()), Identity))
 	{
-		DummyBP->RemoveFromRoot();
-		DummyBP.Reset();
+		++DuplicateNodeCount;
+		return false;
 	}
-	if(Graph.IsValid())
+
+	// Call function nodes are associated with the class owning the function, as in MapToAssociatedClass
+	InitNodeState(Func->GetOwnerClass(), OutState);
+	GT_BuildFunctionDocRecord(Func, GT_ClaimNodeId(OutState, Identity, Func->GetName()), OutState.Record);
+
+	if(Manifest)
 	{
-		Graph->RemoveFromRoot();
-		Graph.Reset();
+		auto const& NodeId = *OutState.Record.Id;
+		auto const Signature = ComputeFunctionSignature(Func, Spawner, SettingsHash);
+		OutState.bUpToDate = Manifest->Update(FDocGenManifest::MakeNodeKey(OutState.ClassId, NodeId), Signature)
+			&& HasNodeArtifacts(OutState, NodeId);
 	}
+
+	return true;
 }
 
-bool FNodeDocsGenerator::GenerateNodeImage(UEdGraphNode* Node, FNodeProcessingState& State)
+void FNodeDocsGenerator::InitNodeState(UClass* AssociatedClass, FNodeProcessingState& OutState)
 {
-	SCOPE_SECONDS_COUNTER(GenerateNodeImageTime);
-
-	const FVector2D DrawSize(1024.0f, 1024.0f);
-
-	bool bSuccess = false;
-
-	AdjustNodeForSnapshot(Node);
+	OutState = FNodeProcessingState();
+	{
+		FScopeLock Lock(&ClassDocsLock);
+		if(!ClassDocsMap.Contains(AssociatedClass))
+		{
+			ClassDocsMap.Add(AssociatedClass, OpenClassDoc(AssociatedClass));
+		}
 
-	FString NodeName = GetNodeDocId(Node);
+		OutState.ClassDoc = ClassDocsMap.FindChecked(AssociatedClass);
+	}
 
-	FIntRect Rect;
+	OutState.ClassId = GetClassDocId(AssociatedClass);
+	OutState.ClassDisplayName = FBlueprintEditorUtils::GetFriendlyClassDisplayName(AssociatedClass).ToString();
+	OutState.ClassDocsPath = OutputDir / GetClassDocId(AssociatedClass);
+	OutState.bGenerateImage = Settings.bGenerateImages;
+}
 
-	TUniquePtr<TImagePixelData<FColor>> PixelData;
+void FNodeDocsGenerator::GT_ReleaseNodes(TArray< UK2Node* > const& Nodes)
+{
+	if(Nodes.Num() == 0)
+	{
+		return;
+	}
 
-	bSuccess = DocGenThreads::RunOnGameThreadRetVal([this, Node, DrawSize, &Rect, &PixelData]
+	// Nodes may have been spawned into any of the graphs which are still alive
+	TMap< UEdGraph*, TSet< UEdGraphNode* > > ReleasedByGraph;
+	for(auto Node : Nodes)
 	{
-		auto NodeWidget = FNodeFactory::CreateNodeWidget(Node);
-		NodeWidget->SetOwner(GraphPanel.ToSharedRef());
+		if(Node == nullptr)
+		{
+			// Documented by reflection, never spawned
+			continue;
+		}
 
-		const bool bUseGammaCorrection = false;
-		FWidgetRenderer Renderer(bUseGammaCorrection);
-		Renderer.SetIsPrepassNeeded(true);
-		auto RenderTarget = Renderer.DrawWidget(NodeWidget.ToSharedRef(), DrawSize);
+		ReleasedByGraph.FindOrAdd(Node->GetGraph()).Add(Node);
+		Node->RemoveFromRoot();
+	}
 
-		auto Desired = NodeWidget->GetDesiredSize();
-	
-		FTextureRenderTargetResource* RTResource = RenderTarget->GameThread_GetRenderTargetResource();
-		Rect = FIntRect(0, 0, (int32)Desired.X, (int32)Desired.Y);
-		FReadSurfaceDataFlags ReadPixelFlags(RCM_UNorm);
-		ReadPixelFlags.SetLinearToGamma(true); // @TODO: is this gamma correction, or something else?
+	for(auto& Entry : ReleasedByGraph)
+	{
+		auto NodeGraph = Entry.Key;
+		auto const& Released = Entry.Value;
 
-		PixelData = MakeUnique<TImagePixelData<FColor>>(FIntPoint((int32)Desired.X, (int32)Desired.Y));
+		// Bypassing UEdGraph::RemoveNode, since we don't want graph change notifications for every node
+		NodeGraph->Nodes.RemoveAllSwap([&Released](UEdGraphNode* Node)
+		{
+			return Released.Contains(Node);
+		});
 
-		if(RTResource->ReadPixelsPtr(PixelData->Pixels.GetData(), ReadPixelFlags, Rect) == false)
+		auto& LiveCount = LiveNodeCounts.FindOrAdd(NodeGraph);
+		LiveCount -= Released.Num();
+		if(LiveCount <= 0 && NodeGraph != Graph.Get())
 		{
-			UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to read pixels for node image."));
-			return false;
+			// Retired graph with nothing left in flight, let it be collected along with anything left in it
+			LiveNodeCounts.Remove(NodeGraph);
+			NodeGraph->RemoveFromRoot();
 		}
-
-		return true;
-	});
-
-	if(!bSuccess)
-	{
-		return false;
 	}
+}
 
-	State.RelImageBasePath = TEXT("../img");
-	FString ImageBasePath = State.ClassDocsPath / TEXT("img");// State.RelImageBasePath;
-	FString ImgFilename = FString::Printf(TEXT("nd_img_%s.png"), *NodeName);
-	FString ScreenshotSaveName = ImageBasePath / ImgFilename;
-
-	TUniquePtr<FImageWriteTask> ImageTask = MakeUnique<FImageWriteTask>();
-	ImageTask->PixelData = MoveTemp(PixelData);
-	ImageTask->Filename = ScreenshotSaveName;
-	ImageTask->Format = EImageFormat::PNG;
-	ImageTask->CompressionQuality = (int32)EImageCompressionQuality::Default;
-	ImageTask->bOverwriteFile = true;
-	ImageTask->PixelPreProcessors.Add(TAsyncAlphaWrite<FColor>(255));
-	
-	if(ImageTask->RunTask())
+void FNodeDocsGenerator::GT_BeginNodeBatch()
+{
+	// Only rotated between batches, so every node in a batch is captured against the panel of the graph it was spawned into
+	if(GraphSpawnCount >= GraphRecycleInterval)
 	{
-		// Success!
-		bSuccess = true;
-		State.ImageFilename = ImgFilename;
+		GT_RotateGraph();
 	}
-	else
+}
+
+/*
+Nodes are spawned into a graph which is replaced after a fixed number of spawns.
+Even with nodes removed once processed, a graph and its panel accumulate state from every spawn (the panel creates a
+widget for each node added), so rotating keeps the cost of spawning flat over a run.
+*/
+void FNodeDocsGenerator::GT_RotateGraph()
+{
+	if(Graph.IsValid())
 	{
-		UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to save screenshot image for node: %s"), *NodeName);
+		auto LiveCount = LiveNodeCounts.Find(Graph.Get());
+		if(LiveCount == nullptr || *LiveCount <= 0)
+		{
+			LiveNodeCounts.Remove(Graph.Get());
+			Graph->RemoveFromRoot();
+		}
+		// Otherwise retired once its remaining nodes are released
 	}
 
-	return bSuccess;
-}
+	FName const GraphName = MakeUniqueObjectName(DummyBP.Get(), UEdGraph::StaticClass(), TEXT("TempoGraph"));
+	Graph = FBlueprintEditorUtils::CreateNewGraph(DummyBP.Get(), GraphName, UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass());
+	Graph->AddToRoot();
+	GraphSpawnCount = 0;
 
-inline FString WrapAsCDATA(FString const& InString)
-{
-	return TEXT("<![CDATA[") + InString + TEXT("]]>");
+	// Panel for the new graph is created on its first capture
+	GraphPanel.Reset();
 }
 
-inline FXmlNode* AppendChild(FXmlNode* Parent, FString const& Name)
+/*
+Slate and render resources are only created once a node actually needs capturing, so that runs without images,
+including headless commandlet runs, never create them.
+*/
+void FNodeDocsGenerator::GT_PrepareCapture()
 {
-	Parent->AppendChildNode(Name, FString());
-	return Parent->GetChildrenNodes().Last();
-}
+	if(!RenderPool.IsValid())
+	{
+		RenderPool = MakeUnique< FNodeRenderPool >();
+	}
 
-inline FXmlNode* AppendChildRaw(FXmlNode* Parent, FString const& Name, FString const& TextContent)
-{
-	Parent->AppendChildNode(Name, TextContent);
-	return Parent->GetChildrenNodes().Last();
+	if(!GraphPanel.IsValid())
+	{
+		GraphPanel = SNew(SGraphPanel)
+			.GraphObj(Graph.Get())
+			;
+		// We want full detail for rendering, passing a super-high zoom value will guarantee the highest LOD.
+		GraphPanel->RestoreViewSettings(FVector2D(0, 0), 10.0f);
+	}
 }
 
-inline FXmlNode* AppendChildCDATA(FXmlNode* Parent, FString const& Name, FString const& TextContent)
+void FNodeDocsGenerator::GT_Finalize()
 {
-	Parent->AppendChildNode(Name, WrapAsCDATA(TextContent));
-	return Parent->GetChildrenNodes().Last();
+	UE_LOG(LogKantanDocGen, Log, TEXT("Node docs used %i distinct strings and %i distinct pin types."), Strings.Num(), PinTexts.NumTypes());
+	UE_LOG(LogKantanDocGen, Log, TEXT("Skipped %i duplicate nodes, renamed %i nodes with colliding doc ids."), DuplicateNodeCount, NodeIdCollisionCount);
+
+	// Capture is complete, release render resources and UObjects while on the game thread.
+	// Docs are held as plain content from here on, so can be saved from any thread.
+	GT_ResolveReadbacks(0);
+	FlushRenderingCommands();
+	CleanUp();
 }
 
-// For K2 pins only!
-bool ExtractPinInformation(UEdGraphPin* Pin, FString& OutName, FString& OutType, FString& OutDescription)
+bool FNodeDocsGenerator::Finalize(FString const& OutputPath)
 {
-	FString Tooltip;
-	Pin->GetOwningNode()->GetPinHoverText(*Pin, Tooltip);
+	// Everything which hasn't already been flushed
+	bool const bClassDocsSaved = FlushClassDocs(true) && !bClassDocWriteFailed;
 
-	if(!Tooltip.IsEmpty())
+	LateClassDocs.Empty();
+	FlushedClasses.Empty();
+	if(Settings.bDirectHtmlOutput)
 	{
-		// @NOTE: This is based on the formatting in UEdGraphSchema_K2::ConstructBasicPinTooltip.
-		// If that is changed, this will fail!
-		
-		auto TooltipPtr = *Tooltip;
-
-		// Parse name line
-		FParse::Line(&TooltipPtr, OutName);
-		// Parse type line
-		FParse::Line(&TooltipPtr, OutType);
-
-		// Currently there is an empty line here, but FParse::Line seems to gobble up empty lines as part of the previous call.
-		// Anyway, attempting here to deal with this generically in case that weird behaviour changes.
-		while(*TooltipPtr == TEXT('\n'))
-		{
-			FString Buf;
-			FParse::Line(&TooltipPtr, Buf);
-		}
-
-		// What remains is the description
-		OutDescription = TooltipPtr;
+		IFileManager::Get().DeleteDirectory(*FPaths::GetPath(GetClassDocXmlPath(FString())), false, true);
 	}
 
-	// @NOTE: Currently overwriting the name and type as suspect this is more robust to future engine changes.
+	if(!bClassDocsSaved)
+	{
+		return false;
+	}
 
-	OutName = Pin->GetDisplayName().ToString();
-	if(OutName.IsEmpty() && Pin->PinType.PinCategory == UEdGraphSchema_K2::PC_Exec)
+	if(Settings.bDirectHtmlOutput)
 	{
-		OutName = Pin->Direction == EEdGraphPinDirection::EGPD_Input ? TEXT("In") : TEXT("Out");
+		return SaveIndexHtml(OutputPath);
 	}
 
-	OutType = UEdGraphSchema_K2::TypeToText(Pin->PinType).ToString();
+	if(!SaveIndexXml(OutputPath))
+	{
+		return false;
+	}
 
 	return true;
 }
 
-TSharedPtr< FXmlFile > FNodeDocsGenerator::InitIndexXml(FString const& IndexTitle)
+bool FNodeDocsGenerator::FlushClassDocs(bool bForce)
 {
-	const FString FileTemplate = R"xxx(<?xml version="1.0" encoding="UTF-8"?>
-<root></root>)xxx";
+	TArray< TPair< TWeakObjectPtr< UClass >, TSharedPtr< FDocGenClassContent, ESPMode::ThreadSafe > > > Completed;
+	{
+		FScopeLock Lock(&ClassDocsLock);
+		for(auto It = ClassDocsMap.CreateIterator(); It; ++It)
+		{
+			// Node states hold a reference to their class doc, so if the map holds the only one, nothing is in flight
+			if(bForce || It.Value().GetSharedReferenceCount() == 1)
+			{
+				Completed.Emplace(It.Key(), MoveTemp(It.Value()));
+				It.RemoveCurrent();
+			}
+		}
+	}
 
-	TSharedPtr< FXmlFile > File = MakeShared< FXmlFile >(FileTemplate, EConstructMethod::ConstructFromBuffer);
-	auto Root = File->GetRootNode();
+	FThreadSafeCounter FailedCount;
+	ParallelFor(Completed.Num(), [&](int32 Idx)
+	{
+		if(!SaveClassDoc(*Completed[Idx].Value))
+		{
+			FailedCount.Increment();
+		}
+	});
 
-	AppendChildCDATA(Root, TEXT("display_name"), IndexTitle);
-	AppendChild(Root, TEXT("classes"));
+	if(FailedCount.GetValue() > 0)
+	{
+		UE_LOG(LogKantanDocGen, Error, TEXT("Failed to write %i of %i class docs."), FailedCount.GetValue(), Completed.Num());
+	}
 
-	return File;
-}
+	bool bSuccess = FailedCount.GetValue() == 0;
+	for(auto& Entry : Completed)
+	{
+		FlushedClasses.Add(Entry.Key);
+		LateClassDocs.Add(MoveTemp(Entry));
+	}
 
-TSharedPtr< FXmlFile > FNodeDocsGenerator::InitClassDocXml(UClass* Class)
-{
-	const FString FileTemplate = R"xxx(<?xml version="1.0" encoding="UTF-8"?>
-<root></root>)xxx";
+	int32 const MaxLateClassDocs = FMath::Max(Settings.LateClassDocBufferSize, 0);
+	int32 const NumToEvict = LateClassDocs.Num() - MaxLateClassDocs;
+	if(NumToEvict > 0)
+	{
+		if(Settings.bDirectHtmlOutput)
+		{
+			// There is no xml to reread these from should they be reopened, so keep a copy on disk
+			for(int32 Idx = 0; Idx < NumToEvict; ++Idx)
+			{
+				auto const& ClassDoc = *LateClassDocs[Idx].Value;
+				bSuccess &= SaveClassDocXml(ClassDoc, GetClassDocXmlPath(ClassDoc.Id));
+			}
+		}
 
-	TSharedPtr< FXmlFile > File = MakeShared< FXmlFile >(FileTemplate, EConstructMethod::ConstructFromBuffer);
-	auto Root = File->GetRootNode();
+		LateClassDocs.RemoveAt(0, NumToEvict);
+	}
 
-	AppendChildCDATA(Root, TEXT("docs_name"), DocsTitle);
-	AppendChildCDATA(Root, TEXT("id"), GetClassDocId(Class));
-	AppendChildCDATA(Root, TEXT("display_name"), FBlueprintEditorUtils::GetFriendlyClassDisplayName(Class).ToString());
-	AppendChild(Root, TEXT("nodes"));
+	if(Completed.Num() > 0)
+	{
+		UE_LOG(LogKantanDocGen, Log, TEXT("Flushed %i class docs."), Completed.Num());
+	}
 
-	return File;
+	bClassDocWriteFailed |= !bSuccess;
+	return bSuccess;
 }
 
-bool FNodeDocsGenerator::UpdateIndexDocWithClass(FXmlFile* DocFile, UClass* Class)
+void FNodeDocsGenerator::CleanUp()
 {
-	auto ClassId = GetClassDocId(Class);
-	auto Classes = DocFile->GetRootNode()->FindChildNode(TEXT("classes"));
-	auto ClassElem = AppendChild(Classes, TEXT("class"));
-	AppendChildCDATA(ClassElem, TEXT("id"), ClassId);
-	AppendChildCDATA(ClassElem, TEXT("display_name"), FBlueprintEditorUtils::GetFriendlyClassDisplayName(Class).ToString());
-	return true;
-}
+	PendingReadbacks.Empty();
+	RenderPool.Reset();
 
-bool FNodeDocsGenerator::UpdateClassDocWithNode(FXmlFile* DocFile, UEdGraphNode* Node)
-{
-	auto NodeId = GetNodeDocId(Node);
-	auto Nodes = DocFile->GetRootNode()->FindChildNode(TEXT("nodes"));
-	auto NodeElem = AppendChild(Nodes, TEXT("node"));
-	AppendChildCDATA(NodeElem, TEXT("id"), NodeId);
-	AppendChildCDATA(NodeElem, TEXT("shorttitle"), Node->GetNodeTitle(ENodeTitleType::ListView).ToString());
-	return true;
-}
+	if(GraphPanel.IsValid())
+	{
+		GraphPanel.Reset();
+	}
 
-inline bool ShouldDocumentPin(UEdGraphPin* Pin)
-{
-	return !Pin->bHidden;
+	if(DummyBP.IsValid())
+	{
+		DummyBP->RemoveFromRoot();
+		DummyBP.Reset();
+	}
+	if(Graph.IsValid())
+	{
+		Graph->RemoveFromRoot();
+		Graph.Reset();
+	}
+
+	// Retired graphs still waiting on nodes
+	for(auto const& Entry : LiveNodeCounts)
+	{
+		Entry.Key->RemoveFromRoot();
+	}
+	LiveNodeCounts.Empty();
 }
 
-bool FNodeDocsGenerator::GenerateNodeDocs(UK2Node* Node, FNodeProcessingState& State)
+bool FNodeDocsGenerator::GT_CaptureNodeImage(UEdGraphNode* Node, FNodeProcessingState& State)
 {
-	SCOPE_SECONDS_COUNTER(GenerateNodeDocsTime);
-
-	auto NodeDocsPath = State.ClassDocsPath / TEXT("nodes");
-	FString DocFilePath = NodeDocsPath / (GetNodeDocId(Node) + TEXT(".xml"));
-
-	const FString FileTemplate = R"xxx(<?xml version="1.0" encoding="UTF-8"?>
-<root></root>)xxx";
+	FScopeSharedSecondsCounter ImageTimer(GenerateNodeImageTime, TimingLock);
 
-	FXmlFile File(FileTemplate, EConstructMethod::ConstructFromBuffer);
-	auto Root = File.GetRootNode();
-	
-	AppendChildCDATA(Root, TEXT("docs_name"), DocsTitle);
-	// Since we pull these from the class xml file, the entries are already CDATA wrapped
-	AppendChildRaw(Root, TEXT("class_id"), State.ClassDocXml->GetRootNode()->FindChildNode(TEXT("id"))->GetContent());//GetClassDocId(Class));
-	AppendChildRaw(Root, TEXT("class_name"), State.ClassDocXml->GetRootNode()->FindChildNode(TEXT("display_name"))->GetContent());// FBlueprintEditorUtils::GetFriendlyClassDisplayName(Class).ToString());
+	GT_PrepareCapture();
+	AdjustNodeForSnapshot(Node);
 
-	FString NodeShortTitle = Node->GetNodeTitle(ENodeTitleType::ListView).ToString();
-	AppendChildCDATA(Root, TEXT("shorttitle"), NodeShortTitle.TrimEnd());
+	auto NodeWidget = FNodeFactory::CreateNodeWidget(Node);
+	NodeWidget->SetOwner(GraphPanel.ToSharedRef());
 
-	FString NodeFullTitle = Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString();
-	auto TargetIdx = NodeFullTitle.Find(TEXT("Target is "), ESearchCase::CaseSensitive);
-	if(TargetIdx != INDEX_NONE)
-	{
-		NodeFullTitle = NodeFullTitle.Left(TargetIdx).TrimEnd();
-	}
-	AppendChildCDATA(Root, TEXT("fulltitle"), NodeFullTitle);
+	// Prepass up front so we can pick a pooled render target of the appropriate size class
+	NodeWidget->SlatePrepass(1.0f);
+	auto Desired = NodeWidget->GetDesiredSize();
 
-	FString NodeDesc = Node->GetTooltipText().ToString();
-	TargetIdx = NodeDesc.Find(TEXT("Target is "), ESearchCase::CaseSensitive);
-	if(TargetIdx != INDEX_NONE)
-	{
-		NodeDesc = NodeDesc.Left(TargetIdx).TrimEnd();
-	}
-	AppendChildCDATA(Root, TEXT("description"), NodeDesc);
-	AppendChildCDATA(Root, TEXT("imgpath"), State.RelImageBasePath / State.ImageFilename);
-	AppendChildCDATA(Root, TEXT("category"), Node->GetMenuCategory().ToString());
-	
-	auto Inputs = AppendChild(Root, TEXT("inputs"));
-	for(auto Pin : Node->Pins)
-	{
-		if(Pin->Direction == EEdGraphPinDirection::EGPD_Input)
-		{
-			if(ShouldDocumentPin(Pin))
-			{
-				auto Input = AppendChild(Inputs, TEXT("param"));
+	auto RenderTarget = RenderPool->GetRenderTarget(Desired);
+	const FVector2D DrawSize(RenderTarget->SizeX, RenderTarget->SizeY);
+	RenderPool->GetRenderer().DrawWidget(RenderTarget, NodeWidget.ToSharedRef(), DrawSize, 0.0f);
 
-				FString PinName, PinType, PinDesc;
-				ExtractPinInformation(Pin, PinName, PinType, PinDesc);
+	Desired = NodeWidget->GetDesiredSize();
+	Desired.X = FMath::Min(Desired.X, DrawSize.X);
+	Desired.Y = FMath::Min(Desired.Y, DrawSize.Y);
 
-				AppendChildCDATA(Input, TEXT("name"), PinName);
-				AppendChildCDATA(Input, TEXT("type"), PinType);
-				AppendChildCDATA(Input, TEXT("description"), PinDesc);
-			}
-		}
-	}
+	FTextureRenderTargetResource* RTResource = RenderTarget->GameThread_GetRenderTargetResource();
+	FIntRect Rect = FIntRect(0, 0, (int32)Desired.X, (int32)Desired.Y);
+	FReadSurfaceDataFlags ReadPixelFlags(RCM_UNorm);
+	ReadPixelFlags.SetLinearToGamma(true); // @TODO: is this gamma correction, or something else?
 
-	auto Outputs = AppendChild(Root, TEXT("outputs"));
-	for(auto Pin : Node->Pins)
+	if(bAsyncReadback)
 	{
-		if(Pin->Direction == EEdGraphPinDirection::EGPD_Output)
-		{
-			if(ShouldDocumentPin(Pin))
+		// Bound the staging memory in flight, waiting on the oldest copy if necessary
+		GT_ResolveReadbacks(MaxPendingReadbacks - 1);
+
+		// The whole target is copied so that the staging texture keeps the target's power of two width, which is what
+		// the mapped rows are assumed to be pitched at. The node's rect is cut out once mapped.
+		auto Readback = MakeShared< FNodeReadback, ESPMode::ThreadSafe >();
+		Readback->GPUReadback = MakeUnique< FRHIGPUTextureReadback >(TEXT("KantanDocGenNodeReadback"));
+		Readback->TargetSize = FIntPoint(RenderTarget->SizeX, RenderTarget->SizeY);
+		Readback->Rect = Rect;
+		State.ReadbackResult = Readback->Promise.GetFuture();
+		State.Readback = Readback;
+		PendingReadbacks.Add(Readback);
+
+		// Copy is queued behind the draw, so the render target can be drawn to again straight away
+		ENQUEUE_RENDER_COMMAND(KantanDocGenCopyNodePixels)(
+			[Readback, RTResource](FRHICommandListImmediate& RHICmdList)
 			{
-				auto Output = AppendChild(Outputs, TEXT("param"));
-
-				FString PinName, PinType, PinDesc;
-				ExtractPinInformation(Pin, PinName, PinType, PinDesc);
+				Readback->GPUReadback->EnqueueCopy(RHICmdList, RTResource->GetRenderTargetTexture());
+			});
 
-				AppendChildCDATA(Output, TEXT("name"), PinName);
-				AppendChildCDATA(Output, TEXT("type"), PinType);
-				AppendChildCDATA(Output, TEXT("description"), PinDesc);
-			}
-		}
+		return true;
 	}
 
-	if(!File.Save(DocFilePath))
-	{
-		return false;
-	}
+	State.PixelData = MakeUnique< TImagePixelData< FColor > >(FIntPoint((int32)Desired.X, (int32)Desired.Y));
 
-	if(!UpdateClassDocWithNode(State.ClassDocXml.Get(), Node))
+	if(RTResource->ReadPixelsPtr(State.PixelData->Pixels.GetData(), ReadPixelFlags, Rect) == false)
 	{
+		UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to read pixels for node image."));
+		State.PixelData.Reset();
 		return false;
 	}
-	
-	return true;
-}
-
-bool FNodeDocsGenerator::SaveIndexXml(FString const& OutDir)
-{
-	auto Path = OutDir / TEXT("index.xml");
-	IndexXml->Save(Path);
 
 	return true;
 }
 
-bool FNodeDocsGenerator::SaveClassDocXml(FString const& OutDir)
+void FNodeDocsGenerator::GT_CaptureNodeImages(TArray< UEdGraphNode* > const& Nodes, TArray< FNodeProcessingState* > const& States, TArray< bool >& OutCaptured)
 {
-	for(auto const& Entry : ClassDocsMap)
+	check(Nodes.Num() == States.Num());
+	OutCaptured.Init(false, Nodes.Num());
+	if(Nodes.Num() == 0)
 	{
-		auto ClassId = GetClassDocId(Entry.Key.Get());
-		auto Path = OutDir / ClassId / (ClassId + TEXT(".xml"));
-		Entry.Value->Save(Path);
+		return;
 	}
 
-	return true;
-}
-
+	GT_PrepareCapture();
 
-void FNodeDocsGenerator::AdjustNodeForSnapshot(UEdGraphNode* Node)
-{
-	// Hide default value box containing 'self' for Target pin
-	if(auto K2_Schema = Cast< UEdGraphSchema_K2 >(Node->GetSchema()))
+	if(!Settings.bAtlasCapture)
 	{
-		if(auto TargetPin = Node->FindPin(K2_Schema->PN_Self))
+		for(int32 Idx = 0; Idx < Nodes.Num(); ++Idx)
 		{
-			TargetPin->bDefaultValueIsIgnored = true;
+			OutCaptured[Idx] = GT_CaptureNodeImage(Nodes[Idx], *States[Idx]);
 		}
+		return;
 	}
-}
 
-FString FNodeDocsGenerator::GetClassDocId(UClass* Class)
-{
-	return Class->GetName();
-}
+	FScopeSharedSecondsCounter ImageTimer(GenerateNodeImageTime, TimingLock);
 
-FString FNodeDocsGenerator::GetNodeDocId(UEdGraphNode* Node)
-{
-	// @TODO: Not sure this is right thing to use
-	return Node->GetDocumentationExcerptName();
-}
+	// Nodes are packed into rows (shelves) left to right, with padding so that nothing bleeds into neighbouring images
+	const int32 AtlasSize = FMath::Clamp(Settings.AtlasSize, 256, FNodeRenderPool::MaxTargetSize);
+	const int32 Padding = 2;
 
+	struct FAtlasEntry
+	{
+		int32 Index;
+		TSharedPtr< SGraphNode > Widget;
+		FVector2D DrawSize;
+		FIntRect Rect;
+	};
 
-#include "BlueprintVariableNodeSpawner.h"
-#include "BlueprintDelegateNodeSpawner.h"
-#include "K2Node_CallFunction.h"
-#include "K2Node_DynamicCast.h"
+	TArray< FAtlasEntry > Pending;
+	FIntPoint Cursor(0, 0);
+	int32 ShelfHeight = 0;
+
+	auto RenderPending = [&]
+	{
+		if(Pending.Num() == 0)
+		{
+			return;
+		}
+
+		auto Canvas = SNew(SCanvas);
+		FIntPoint Extent(0, 0);
+		for(auto const& Entry : Pending)
+		{
+			Canvas->AddSlot()
+				.Position(FVector2D(Entry.Rect.Min))
+				.Size(Entry.DrawSize)
+				[
+					Entry.Widget.ToSharedRef()
+				];
+			Extent = Extent.ComponentMax(Entry.Rect.Max);
+		}
+
+		auto RenderTarget = RenderPool->GetRenderTarget(FVector2D(Extent));
+		RenderPool->GetRenderer().DrawWidget(RenderTarget, Canvas, FVector2D(RenderTarget->SizeX, RenderTarget->SizeY), 0.0f);
+
+		auto Atlas = MakeShared< FNodeImageAtlas, ESPMode::ThreadSafe >();
+		Atlas->Size = Extent;
+		Atlas->Pixels.SetNumUninitialized(Extent.X * Extent.Y);
+
+		FTextureRenderTargetResource* RTResource = RenderTarget->GameThread_GetRenderTargetResource();
+		FReadSurfaceDataFlags ReadPixelFlags(RCM_UNorm);
+		ReadPixelFlags.SetLinearToGamma(true);
+
+		// Single readback for the whole batch
+		if(RTResource->ReadPixelsPtr(Atlas->Pixels.GetData(), ReadPixelFlags, FIntRect(FIntPoint(0, 0), Extent)))
+		{
+			for(auto const& Entry : Pending)
+			{
+				auto& State = *States[Entry.Index];
+				State.Atlas = Atlas;
+				State.AtlasRect = Entry.Rect;
+				OutCaptured[Entry.Index] = true;
+			}
+		}
+		else
+		{
+			UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to read pixels for node image atlas."));
+		}
+
+		Pending.Reset();
+		Cursor = FIntPoint(0, 0);
+		ShelfHeight = 0;
+	};
+
+	for(int32 Idx = 0; Idx < Nodes.Num(); ++Idx)
+	{
+		auto Node = Nodes[Idx];
+		AdjustNodeForSnapshot(Node);
+
+		auto NodeWidget = FNodeFactory::CreateNodeWidget(Node);
+		NodeWidget->SetOwner(GraphPanel.ToSharedRef());
+		NodeWidget->SlatePrepass(1.0f);
+
+		auto const Desired = NodeWidget->GetDesiredSize();
+		FIntPoint const Size((int32)Desired.X, (int32)Desired.Y);
+		FIntPoint const Footprint(FMath::CeilToInt(Desired.X) + Padding, FMath::CeilToInt(Desired.Y) + Padding);
+
+		if(Footprint.X > AtlasSize || Footprint.Y > AtlasSize)
+		{
+			// Too big to share a render target
+			OutCaptured[Idx] = GT_CaptureNodeImage(Node, *States[Idx]);
+			continue;
+		}
+
+		if(Cursor.X + Footprint.X > AtlasSize)
+		{
+			// Start a new shelf
+			Cursor = FIntPoint(0, Cursor.Y + ShelfHeight);
+			ShelfHeight = 0;
+		}
+
+		if(Cursor.Y + Footprint.Y > AtlasSize)
+		{
+			// Atlas full
+			RenderPending();
+		}
+
+		FAtlasEntry Entry;
+		Entry.Index = Idx;
+		Entry.Widget = NodeWidget;
+		Entry.DrawSize = Desired;
+		Entry.Rect = FIntRect(Cursor, Cursor + Size);
+		Pending.Add(MoveTemp(Entry));
+
+		Cursor.X += Footprint.X;
+		ShelfHeight = FMath::Max(ShelfHeight, Footprint.Y);
+	}
+
+	RenderPending();
+}
+
+void FNodeDocsGenerator::SliceAtlasImage(FNodeProcessingState& State)
+{
+	auto const Size = State.AtlasRect.Size();
+	auto const& Atlas = *State.Atlas;
+
+	State.PixelData = MakeUnique< TImagePixelData< FColor > >(Size);
+	State.PixelData->Pixels.SetNumUninitialized(Size.X * Size.Y);
+	for(int32 Row = 0; Row < Size.Y; ++Row)
+	{
+		FMemory::Memcpy(
+			&State.PixelData->Pixels[Row * Size.X],
+			&Atlas.Pixels[(State.AtlasRect.Min.Y + Row) * Atlas.Size.X + State.AtlasRect.Min.X],
+			Size.X * sizeof(FColor)
+		);
+	}
+
+	// Atlas is freed once the last node in the batch has been sliced
+	State.Atlas.Reset();
+}
+
+void FNodeDocsGenerator::GT_ResolveReadbacks(int32 MaxOutstanding)
+{
+	auto IsResolved = [](TSharedPtr< FNodeReadback, ESPMode::ThreadSafe > const& Readback)
+	{
+		return (bool)Readback->bResolved;
+	};
+
+	PendingReadbacks.RemoveAll(IsResolved);
+	if(PendingReadbacks.Num() == 0)
+	{
+		return;
+	}
+
+	int32 const NumToWaitFor = FMath::Max(PendingReadbacks.Num() - FMath::Max(MaxOutstanding, 0), 0);
+	ENQUEUE_RENDER_COMMAND(KantanDocGenResolveNodeReadbacks)(
+		[Readbacks = PendingReadbacks, NumToWaitFor](FRHICommandListImmediate& RHICmdList)
+		{
+			for(int32 Idx = 0; Idx < Readbacks.Num(); ++Idx)
+			{
+				auto& Readback = *Readbacks[Idx];
+				if(Readback.bResolved)
+				{
+					continue;
+				}
+
+				if(!Readback.GPUReadback->IsReady())
+				{
+					if(Idx >= NumToWaitFor)
+					{
+						// Still in flight and we're within the limit, check again later
+						continue;
+					}
+
+					RHICmdList.ImmediateFlush(EImmediateFlushType::FlushRHIThread);
+					while(!Readback.GPUReadback->IsReady())
+					{
+						FPlatformProcess::SleepNoStats(0.0f);
+					}
+				}
+
+				ResolveReadback_RenderThread(Readback);
+			}
+		});
+
+	if(NumToWaitFor > 0)
+	{
+		FlushRenderingCommands();
+		PendingReadbacks.RemoveAll(IsResolved);
+	}
+}
+
+void FNodeDocsGenerator::ResolveReadback_RenderThread(FNodeReadback& Readback)
+{
+	auto const Size = Readback.Rect.Size();
+	auto const NumBytes = Readback.TargetSize.X * Readback.TargetSize.Y * sizeof(FColor);
+
+	bool bSuccess = false;
+	if(auto Mapped = static_cast< FColor const* >(Readback.GPUReadback->Lock(NumBytes)))
+	{
+		Readback.PixelData = MakeUnique< TImagePixelData< FColor > >(Size);
+		Readback.PixelData->Pixels.SetNumUninitialized(Size.X * Size.Y);
+		for(int32 Row = 0; Row < Size.Y; ++Row)
+		{
+			FMemory::Memcpy(
+				&Readback.PixelData->Pixels[Row * Size.X],
+				&Mapped[(Readback.Rect.Min.Y + Row) * Readback.TargetSize.X + Readback.Rect.Min.X],
+				Size.X * sizeof(FColor)
+			);
+		}
+		Readback.GPUReadback->Unlock();
+		bSuccess = true;
+	}
+
+	// Staging texture is released here on the render thread
+	Readback.GPUReadback.Reset();
+	Readback.Promise.SetValue(bSuccess);
+	Readback.bResolved = true;
+}
+
+bool FNodeDocsGenerator::CompleteReadback(FNodeProcessingState& State)
+{
+	if(!State.ReadbackResult.IsReady())
+	{
+		// Got ahead of the game thread's polling, have it wait out everything still in flight
+		DocGenThreads::RunOnGameThread([this]
+		{
+			GT_ResolveReadbacks(0);
+		});
+	}
+
+	bool const bSuccess = State.ReadbackResult.Get();
+	if(bSuccess)
+	{
+		State.PixelData = MoveTemp(State.Readback->PixelData);
+	}
+
+	State.Readback.Reset();
+	State.ReadbackResult = TFuture< bool >();
+	return bSuccess;
+}
+
+bool FNodeDocsGenerator::WriteNodeImage(FNodeProcessingState& State)
+{
+	FScopeSharedSecondsCounter ImageTimer(GenerateNodeImageTime, TimingLock);
+
+	if(State.bUpToDate || !State.bGenerateImage)
+	{
+		// Reusing the image from the previous run, or not including images at all
+		return true;
+	}
+
+	check(State.Record.IsValid());
+	FString const& NodeName = *State.Record.Id;
+
+	State.RelImageBasePath = TEXT("../img");
+	FString ImageBasePath = State.ClassDocsPath / TEXT("img");// State.RelImageBasePath;
+	FString ImgFilename = GetNodeImageFilename(NodeName);
+	FString ScreenshotSaveName = ImageBasePath / ImgFilename;
+
+	if(State.bImageCached)
+	{
+		// Identical node was rendered previously, no need to encode anything
+		if(!ImageCache->Retrieve(State.ImageCacheKey, ScreenshotSaveName))
+		{
+			return false;
+		}
+
+		ImageCacheHits.Increment();
+		State.ImageFilename = ImgFilename;
+		return true;
+	}
+
+	if(!State.PixelData.IsValid() && State.Atlas.IsValid())
+	{
+		SliceAtlasImage(State);
+	}
+
+	if(!State.PixelData.IsValid() && State.Readback.IsValid() && !CompleteReadback(State))
+	{
+		UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to read pixels for node image."));
+		return false;
+	}
+
+	if(!State.PixelData.IsValid())
+	{
+		return false;
+	}
+
+	TUniquePtr<FImageWriteTask> ImageTask = MakeUnique<FImageWriteTask>();
+	ImageTask->PixelData = MoveTemp(State.PixelData);
+	ImageTask->Filename = ScreenshotSaveName;
+	ImageTask->Format = EImageFormat::PNG;
+	ImageTask->CompressionQuality = (int32)EImageCompressionQuality::Default;
+	ImageTask->bOverwriteFile = true;
+	ImageTask->PixelPreProcessors.Add(TAsyncAlphaWrite<FColor>(255));
+
+	// Encoding and writing happen asynchronously on the image write queue. Failures are reported when the
+	// write completes, either when throttling or at the final flush.
+	FPendingImageWrite Write;
+	Write.NodeName = NodeName;
+	Write.ImagePath = ScreenshotSaveName;
+	Write.CacheKey = State.ImageCacheKey;
+	Write.Result = ImageWriteQueue->Enqueue(MoveTemp(ImageTask));
+	TrackImageWrite(MoveTemp(Write));
+	State.ImageFilename = ImgFilename;
+
+	return true;
+}
+
+void FNodeDocsGenerator::TrackImageWrite(FPendingImageWrite&& Write)
+{
+	FPendingImageWrite Oldest;
+	{
+		FScopeLock Lock(&ImageWritesLock);
+
+		// Retire any which have already finished
+		for(int32 Idx = PendingImageWrites.Num() - 1; Idx >= 0; --Idx)
+		{
+			if(PendingImageWrites[Idx].Result.IsReady())
+			{
+				CompleteImageWrite(PendingImageWrites[Idx]);
+				PendingImageWrites.RemoveAt(Idx, 1, false);
+			}
+		}
+
+		if(PendingImageWrites.Num() >= MaxPendingImageWrites)
+		{
+			Oldest = MoveTemp(PendingImageWrites[0]);
+			PendingImageWrites.RemoveAt(0, 1, false);
+		}
+
+		PendingImageWrites.Add(MoveTemp(Write));
+	}
+
+	// Too many writes in flight, wait on the oldest outside of the lock
+	if(Oldest.Result.IsValid())
+	{
+		CompleteImageWrite(Oldest);
+	}
+}
+
+void FNodeDocsGenerator::CompleteImageWrite(FPendingImageWrite& Write)
+{
+	if(!Write.Result.Get())
+	{
+		UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to save screenshot image for node: %s"), *Write.NodeName);
+		FailedImageWrites.Increment();
+		return;
+	}
+
+	// Populate the cache only once the image is fully written
+	if(ImageCache.IsValid() && !Write.CacheKey.IsEmpty())
+	{
+		ImageCache->Store(Write.CacheKey, Write.ImagePath);
+	}
+}
+
+int32 FNodeDocsGenerator::FlushImageWrites()
+{
+	if(ImageWriteQueue)
+	{
+		ImageWriteQueue->CreateFence().Wait();
+	}
+
+	TArray< FPendingImageWrite > Remaining;
+	{
+		FScopeLock Lock(&ImageWritesLock);
+		Remaining = MoveTemp(PendingImageWrites);
+	}
+
+	for(auto& Write : Remaining)
+	{
+		CompleteImageWrite(Write);
+	}
+
+	return FailedImageWrites.GetValue();
+}
+
+// For K2 pins only!
+static FString ExtractPinDescription(UEdGraphPin* Pin)
+{
+	FString Tooltip;
+	Pin->GetOwningNode()->GetPinHoverText(*Pin, Tooltip);
+
+	if(Tooltip.IsEmpty())
+	{
+		return FString();
+	}
+
+	// @NOTE: This is based on the formatting in UEdGraphSchema_K2::ConstructBasicPinTooltip.
+	// If that is changed, this will fail!
+	// Name and type are taken from the pin directly, as suspect this is more robust to future engine changes.
+
+	auto TooltipPtr = *Tooltip;
+
+	// Skip name and type lines
+	FString Buf;
+	FParse::Line(&TooltipPtr, Buf);
+	FParse::Line(&TooltipPtr, Buf);
+
+	// Currently there is an empty line here, but FParse::Line seems to gobble up empty lines as part of the previous call.
+	// Anyway, attempting here to deal with this generically in case that weird behaviour changes.
+	while(*TooltipPtr == TEXT('\n'))
+	{
+		FParse::Line(&TooltipPtr, Buf);
+	}
+
+	// What remains is the description
+	return TooltipPtr;
+}
+
+static FString GetPinDocName(UEdGraphPin* Pin)
+{
+	FString Name = Pin->GetDisplayName().ToString();
+	if(Name.IsEmpty() && Pin->PinType.PinCategory == UEdGraphSchema_K2::PC_Exec)
+	{
+		Name = Pin->Direction == EEdGraphPinDirection::EGPD_Input ? TEXT("In") : TEXT("Out");
+	}
+	return Name;
+}
+
+void FNodeDocsGenerator::WriteIndexXml(FDocGenXmlWriter& Writer, FDocGenIndexContent const& Index)
+{
+	Writer.BeginElement(TEXT("root"));
+	Writer.WriteCDATAElement(TEXT("display_name"), Index.DisplayName);
+	Writer.BeginElement(TEXT("classes"));
+	for(auto const& Class : Index.Classes)
+	{
+		Writer.BeginElement(TEXT("class"));
+		Writer.WriteCDATAElement(TEXT("id"), Class.Id);
+		Writer.WriteCDATAElement(TEXT("display_name"), Class.DisplayName);
+		Writer.EndElement();
+	}
+	Writer.EndElement();
+	Writer.EndElement();
+}
+
+void FNodeDocsGenerator::WriteClassDocXml(FDocGenXmlWriter& Writer, FDocGenClassContent const& ClassDoc)
+{
+	Writer.BeginElement(TEXT("root"));
+	Writer.WriteCDATAElement(TEXT("docs_name"), ClassDoc.DocsName);
+	Writer.WriteCDATAElement(TEXT("id"), ClassDoc.Id);
+	Writer.WriteCDATAElement(TEXT("display_name"), ClassDoc.DisplayName);
+	Writer.BeginElement(TEXT("nodes"));
+	for(auto const& Node : ClassDoc.Nodes)
+	{
+		Writer.BeginElement(TEXT("node"));
+		Writer.WriteCDATAElement(TEXT("id"), Node.Id);
+		Writer.WriteCDATAElement(TEXT("shorttitle"), Node.ShortTitle);
+		Writer.EndElement();
+	}
+	Writer.EndElement();
+	Writer.EndElement();
+}
+
+void FNodeDocsGenerator::WriteNodeDocXml(FDocGenXmlWriter& Writer, FDocGenNodeContent const& Content)
+{
+	WriteNodeDocXml(Writer, Content, TArray< FDocGenParamRef >(Content.Inputs), TArray< FDocGenParamRef >(Content.Outputs));
+}
+
+void FNodeDocsGenerator::WriteNodeDocXml(FDocGenXmlWriter& Writer, FDocGenNodeContent const& Content, TArray< FDocGenParamRef > const& Inputs, TArray< FDocGenParamRef > const& Outputs)
+{
+	Writer.BeginElement(TEXT("root"));
+	Writer.WriteCDATAElement(TEXT("docs_name"), Content.DocsName);
+	Writer.WriteCDATAElement(TEXT("class_id"), Content.ClassId);
+	Writer.WriteCDATAElement(TEXT("class_name"), Content.ClassName);
+	Writer.WriteCDATAElement(TEXT("shorttitle"), Content.ShortTitle);
+	Writer.WriteCDATAElement(TEXT("fulltitle"), Content.FullTitle);
+	Writer.WriteCDATAElement(TEXT("description"), Content.Description);
+	Writer.WriteCDATAElement(TEXT("imgpath"), Content.ImgPath);
+	Writer.WriteCDATAElement(TEXT("category"), Content.Category);
+
+	auto WriteParams = [&Writer](TCHAR const* Name, TArray< FDocGenParamRef > const& Params)
+	{
+		Writer.BeginElement(Name);
+		for(auto const& Param : Params)
+		{
+			Writer.BeginElement(TEXT("param"));
+			Writer.WriteCDATAElement(TEXT("name"), *Param.Name);
+			Writer.WriteCDATAElement(TEXT("type"), *Param.Type);
+			Writer.WriteCDATAElement(TEXT("description"), *Param.Description);
+			Writer.EndElement();
+		}
+		Writer.EndElement();
+	};
+
+	WriteParams(TEXT("inputs"), Inputs);
+	WriteParams(TEXT("outputs"), Outputs);
+
+	Writer.EndElement();
+}
+
+TSharedPtr< FDocGenClassContent, ESPMode::ThreadSafe > FNodeDocsGenerator::InitClassDoc(UClass* Class)
+{
+	TSharedPtr< FDocGenClassContent, ESPMode::ThreadSafe > ClassDoc = MakeShared< FDocGenClassContent, ESPMode::ThreadSafe >();
+	ClassDoc->DocsName = DocsTitle;
+	ClassDoc->Id = GetClassDocId(Class);
+	ClassDoc->DisplayName = FBlueprintEditorUtils::GetFriendlyClassDisplayName(Class).ToString();
+	return ClassDoc;
+}
+
+/*
+Class docs are normally opened once, but nodes which map to a class other than their source object's may arrive after
+the class has been flushed. These reopen the doc, from memory if recent enough or otherwise from its saved xml.
+*/
+TSharedPtr< FDocGenClassContent, ESPMode::ThreadSafe > FNodeDocsGenerator::OpenClassDoc(UClass* Class)
+{
+	for(int32 Idx = 0; Idx < LateClassDocs.Num(); ++Idx)
+	{
+		if(LateClassDocs[Idx].Key == Class)
+		{
+			auto ClassDoc = MoveTemp(LateClassDocs[Idx].Value);
+			LateClassDocs.RemoveAt(Idx);
+			return ClassDoc;
+		}
+	}
+
+	if(FlushedClasses.Contains(Class))
+	{
+		auto ClassDoc = MakeShared< FDocGenClassContent, ESPMode::ThreadSafe >();
+		if(FIntermediateDocReader::ReadClass(GetClassDocXmlPath(GetClassDocId(Class)), *ClassDoc))
+		{
+			return ClassDoc;
+		}
+
+		UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to reopen class doc for %s, some nodes will be missing from its page."), *GetClassDocId(Class));
+	}
+	else
+	{
+		// New class doc, update the index
+		UpdateIndexDocWithClass(IndexDoc, Class);
+	}
+
+	return InitClassDoc(Class);
+}
+
+bool FNodeDocsGenerator::UpdateIndexDocWithClass(FDocGenIndexContent& Index, UClass* Class)
+{
+	FDocGenClassRef ClassRef;
+	ClassRef.Id = GetClassDocId(Class);
+	ClassRef.DisplayName = FBlueprintEditorUtils::GetFriendlyClassDisplayName(Class).ToString();
+	Index.Classes.Add(MoveTemp(ClassRef));
+	return true;
+}
+
+bool FNodeDocsGenerator::UpdateClassDocWithNode(FDocGenClassContent& ClassDoc, FDocGenNodeContent const& Node)
+{
+	FDocGenNodeRef NodeRef;
+	NodeRef.Id = Node.Id;
+	NodeRef.ShortTitle = Node.ShortTitle;
+	ClassDoc.Nodes.Add(MoveTemp(NodeRef));
+	return true;
+}
+
+inline bool ShouldDocumentPin(UEdGraphPin* Pin)
+{
+	return !Pin->bHidden;
+}
+
+bool FNodeDocsGenerator::GenerateNodeDocs(FNodeProcessingState& State)
+{
+	FScopeSharedSecondsCounter DocsTimer(GenerateNodeDocsTime, TimingLock);
+
+	FDocGenNodeContent Content;
+	if(State.bUpToDate)
+	{
+		// Doc file from the previous run is reused, only the class doc needs to know about the node
+		Content.Id = *State.Record.Id;
+		Content.ShortTitle = *State.Record.ShortTitle;
+
+		FScopeLock Lock(&ClassDocsLock);
+		return UpdateClassDocWithNode(*State.ClassDoc, Content);
+	}
+
+	if(!BuildNodeDocContent(State.Record, State, Content))
+	{
+		return false;
+	}
+
+	// Params are output straight from the interned strings of the record
+	auto const& Inputs = State.Record.Inputs;
+	auto const& Outputs = State.Record.Outputs;
+	auto NodeDocsPath = State.ClassDocsPath / TEXT("nodes");
+	if(Settings.bDirectHtmlOutput)
+	{
+		// Stream straight to the final page
+		if(!FHtmlDocRenderer::WritePage(NodeDocsPath / (Content.Id + TEXT(".html")), FHtmlDocRenderer::RenderNodePage(Content, Inputs, Outputs)))
+		{
+			return false;
+		}
+	}
+	else if(!SaveNodeDocXml(Content, Inputs, Outputs, NodeDocsPath / (Content.Id + TEXT(".xml"))))
+	{
+		return false;
+	}
+
+	{
+		FScopeLock Lock(&ClassDocsLock);
+		if(!UpdateClassDocWithNode(*State.ClassDoc, Content))
+		{
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+/*
+Captures everything the docs need from the node, trimmed as it should appear in the output.
+Display text and pin tooltips are only available from a live node on the game thread, so this is taken as soon as
+the node is spawned, after which the node is only needed for rendering its image.
+*/
+void FNodeDocsGenerator::GT_CaptureNodeRecord(UK2Node* Node, FString const& NodeId, FNodeDocRecord& OutRecord)
+{
+	auto TrimTarget = [](FString Str)
+	{
+		auto const TargetIdx = Str.Find(TEXT("Target is "), ESearchCase::CaseSensitive);
+		if(TargetIdx != INDEX_NONE)
+		{
+			Str = Str.Left(TargetIdx).TrimEnd();
+		}
+		return Str;
+	};
+
+	OutRecord = FNodeDocRecord();
+	OutRecord.Id = Strings.Intern(NodeId);
+	OutRecord.ShortTitle = Strings.Intern(Node->GetNodeTitle(ENodeTitleType::ListView).ToString().TrimEnd());
+	OutRecord.FullTitle = Strings.Intern(TrimTarget(Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString()));
+	OutRecord.Description = Strings.Intern(TrimTarget(Node->GetTooltipText().ToString()));
+	OutRecord.Category = Strings.Intern(Node->GetMenuCategory().ToString());
+
+	// Pin tooltips of function calls are generated from the function alone, so can be shared by every node calling it
+	auto CallFuncNode = Cast< UK2Node_CallFunction >(Node);
+	UFunction* Func = CallFuncNode ? CallFuncNode->GetTargetFunction() : nullptr;
+
+	for(auto Pin : Node->Pins)
+	{
+		if(ShouldDocumentPin(Pin))
+		{
+			auto& Params = Pin->Direction == EEdGraphPinDirection::EGPD_Input ? OutRecord.Inputs : OutRecord.Outputs;
+
+			FString const* Description = Func ? PinTexts.FindParamDescription(Func, Pin->PinName) : nullptr;
+			if(Description == nullptr)
+			{
+				Description = Func
+					? PinTexts.AddParamDescription(Func, Pin->PinName, ExtractPinDescription(Pin))
+					: Strings.Intern(ExtractPinDescription(Pin));
+			}
+
+			Params.Emplace(Strings.Intern(GetPinDocName(Pin)), PinTexts.GetTypeText(Pin->PinType), Description);
+		}
+	}
+}
+
+bool FNodeDocsGenerator::BuildNodeDocContent(FNodeDocRecord const& Record, FNodeProcessingState const& State, FDocGenNodeContent& OutContent)
+{
+	if(!Record.IsValid())
+	{
+		return false;
+	}
+
+	OutContent.Id = *Record.Id;
+	OutContent.DocsName = DocsTitle;
+	OutContent.ClassId = State.ClassId;
+	OutContent.ClassName = State.ClassDisplayName;
+	OutContent.ShortTitle = *Record.ShortTitle;
+	OutContent.FullTitle = *Record.FullTitle;
+	OutContent.Description = *Record.Description;
+	OutContent.ImgPath = State.RelImageBasePath / State.ImageFilename;
+	OutContent.Category = *Record.Category;
+	return true;
+}
 
 /*
-This takes a graph node object and attempts to map it to the class which the node conceptually belong to.
-If there is no special mapping for the node, the function determines the class from the source object.
+Text for the param of a function with the given name, taken from the '@param' or '@return' lines of its tooltip.
+Mirrors what UK2Node_CallFunction puts in its pin tooltips.
 */
-UClass* FNodeDocsGenerator::MapToAssociatedClass(UK2Node* NodeInst, UObject* Source)
+static FString ExtractParamDescription(FString const& FunctionTooltip, FString const& ParamName, bool bIsReturn)
 {
-	// For nodes derived from UK2Node_CallFunction, associate with the class owning the called function.
-	if(auto FuncNode = Cast< UK2Node_CallFunction >(NodeInst))
+	static const FString ParamTag = TEXT("@param");
+	static const FString ReturnTag = TEXT("@return");
+
+	int32 SearchFrom = 0;
+	for(;;)
 	{
-		auto Func = FuncNode->GetTargetFunction();
-		if(Func)
+		auto const& Tag = bIsReturn ? ReturnTag : ParamTag;
+		int32 const TagIdx = FunctionTooltip.Find(Tag, ESearchCase::IgnoreCase, ESearchDir::FromStart, SearchFrom);
+		if(TagIdx == INDEX_NONE)
 		{
-			return Func->GetOwnerClass();
+			return FString();
+		}
+
+		int32 const EndIdx = FunctionTooltip.Find(TEXT("@"), ESearchCase::CaseSensitive, ESearchDir::FromStart, TagIdx + 1);
+		FString Entry = FunctionTooltip.Mid(TagIdx + Tag.Len(), EndIdx == INDEX_NONE ? MAX_int32 : EndIdx - TagIdx - Tag.Len()).TrimStartAndEnd();
+		SearchFrom = TagIdx + Tag.Len();
+
+		if(bIsReturn)
+		{
+			return Entry;
+		}
+
+		FString Name, Desc;
+		if(!Entry.Split(TEXT(" "), &Name, &Desc))
+		{
+			Name = Entry;
+		}
+		if(Name.Equals(ParamName, ESearchCase::IgnoreCase))
+		{
+			return Desc.TrimStartAndEnd();
 		}
 	}
+}
 
-	// Default fallback
-	if(auto SourceClass = Cast< UClass >(Source))
+/*
+Builds the same record as GT_CaptureNodeRecord would for a UK2Node_CallFunction of the function, from reflection data alone.
+Text and metadata lookups aren't safe off the game thread, so as with spawned nodes the record is captured here and
+workers only ever see its interned strings.
+*/
+bool FNodeDocsGenerator::GT_BuildFunctionDocRecord(UFunction* Func, FString const& NodeId, FNodeDocRecord& OutRecord)
+{
+	OutRecord = FNodeDocRecord();
+	OutRecord.Id = Strings.Intern(NodeId);
+
+	// The full title of a call function node is the function name followed by the 'Target is' line, which is stripped anyway
+	OutRecord.ShortTitle = Strings.Intern(UK2Node_CallFunction::GetUserFacingFunctionName(Func).ToString().TrimEnd());
+	OutRecord.FullTitle = OutRecord.ShortTitle;
+	OutRecord.Description = Strings.Intern(UK2Node_CallFunction::GetDefaultTooltipForFunction(Func));
+	OutRecord.Category = Strings.Intern(UK2Node_CallFunction::GetDefaultCategoryForFunction(Func, FText::GetEmpty()).ToString());
+
+	auto K2Schema = GetDefault< UEdGraphSchema_K2 >();
+
+	if(!Func->HasAnyFunctionFlags(FUNC_BlueprintPure))
 	{
-		return SourceClass;
+		FString const* ExecType = PinTexts.GetTypeText(FEdGraphPinType(UEdGraphSchema_K2::PC_Exec, NAME_None, nullptr, EPinContainerType::None, false, FEdGraphTerminalType()));
+		OutRecord.Inputs.Emplace(Strings.Intern(TEXT("In")), ExecType, Strings.Empty());
+		OutRecord.Outputs.Emplace(Strings.Intern(Func->HasMetaData(FBlueprintMetadata::MD_Latent) ? TEXT("Completed") : TEXT("Out")), ExecType, Strings.Empty());
 	}
-	else if(auto SourceBP = Cast< UBlueprint >(Source))
+
+	if(!Func->HasAnyFunctionFlags(FUNC_Static) && !Func->HasMetaData(FBlueprintMetadata::MD_HideSelfPin))
 	{
-		return SourceBP->GeneratedClass;
+		FEdGraphPinType SelfType(UEdGraphSchema_K2::PC_Object, NAME_None, Func->GetOwnerClass(), EPinContainerType::None, false, FEdGraphTerminalType());
+		OutRecord.Inputs.Emplace(Strings.Intern(TEXT("Target")), PinTexts.GetTypeText(SelfType), Strings.Empty());
 	}
-	else
+
+	// Params the node would hide when spawned into our graph, using the same rules as UK2Node_CallFunction
+	// (WorldContext, LatentInfo, comma separated HidePin and InternalUseParam lists)
+	TSet< FName > HiddenParams;
+	FBlueprintEditorUtils::GetHiddenPinsForFunction(Graph.Get(), Func, HiddenParams);
+
+	FString const* FunctionTooltip = nullptr;
+	for(TFieldIterator< FProperty > It(Func); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
 	{
-		return nullptr;
+		auto Param = *It;
+		if(HiddenParams.Contains(Param->GetFName()))
+		{
+			continue;
+		}
+
+		bool const bIsReturn = Param->HasAnyPropertyFlags(CPF_ReturnParm);
+		bool const bIsOutput = bIsReturn || (Param->HasAnyPropertyFlags(CPF_OutParm) && !Param->HasAnyPropertyFlags(CPF_ReferenceParm | CPF_ConstParm));
+
+		FEdGraphPinType PinType;
+		if(!K2Schema->ConvertPropertyToPinType(Param, PinType))
+		{
+			continue;
+		}
+
+		FString const* Description = PinTexts.FindParamDescription(Func, Param->GetFName());
+		if(Description == nullptr)
+		{
+			if(FunctionTooltip == nullptr)
+			{
+				FunctionTooltip = &Func->GetMetaData(FBlueprintMetadata::MD_Tooltip);
+			}
+			Description = PinTexts.AddParamDescription(Func, Param->GetFName(), ExtractParamDescription(*FunctionTooltip, Param->GetName(), bIsReturn));
+		}
+
+		(bIsOutput ? OutRecord.Outputs : OutRecord.Inputs).Emplace(Strings.Intern(Param->GetDisplayNameText().ToString()), PinTexts.GetTypeText(PinType), Description);
 	}
+
+	return true;
 }
 
-bool FNodeDocsGenerator::IsSpawnerDocumentable(UBlueprintNodeSpawner* Spawner, bool bIsBlueprint)
+bool FNodeDocsGenerator::SaveNodeDocXml(FDocGenNodeContent const& Content, TArray< FDocGenParamRef > const& Inputs, TArray< FDocGenParamRef > const& Outputs, FString const& Path)
 {
-	// Spawners of or deriving from the following classes will be excluded
-	static const TSubclassOf< UBlueprintNodeSpawner > ExcludedSpawnerClasses[] = {
-		UBlueprintVariableNodeSpawner::StaticClass(),
-		UBlueprintDelegateNodeSpawner::StaticClass(),
-		UBlueprintBoundNodeSpawner::StaticClass(),
-		UBlueprintComponentNodeSpawner::StaticClass(),
-	};
+	auto& Writer = FDocGenXmlWriter::GetThreadWriter();
+	WriteNodeDocXml(Writer, Content, Inputs, Outputs);
+	return Writer.SaveToFile(Path);
+}
 
-	// Spawners of or deriving from the following classes will be excluded in a blueprint context
-	static const TSubclassOf< UBlueprintNodeSpawner > BlueprintOnlyExcludedSpawnerClasses[] = {
-		UBlueprintEventNodeSpawner::StaticClass(),
-	};
+bool FNodeDocsGenerator::SaveIndexXml(FString const& OutDir)
+{
+	auto Path = OutDir / TEXT("index.xml");
+	auto& Writer = FDocGenXmlWriter::GetThreadWriter();
+	WriteIndexXml(Writer, IndexDoc);
+	return Writer.SaveToFile(Path);
+}
 
-	// Spawners for nodes of these types (or their subclasses) will be excluded
-	static const TSubclassOf< UK2Node > ExcludedNodeClasses[] = {
-		UK2Node_DynamicCast::StaticClass(),
-		UK2Node_Message::StaticClass(),
-	};
+bool FNodeDocsGenerator::SaveClassDocXml(FDocGenClassContent const& ClassDoc, FString const& Path)
+{
+	auto& Writer = FDocGenXmlWriter::GetThreadWriter();
+	WriteClassDocXml(Writer, ClassDoc);
+	return Writer.SaveToFile(Path);
+}
 
-	// Function spawners for functions with any of the following metadata tags will also be excluded
-	static const FName ExcludedFunctionMeta[] = {
-		TEXT("BlueprintAutocast")
-	};
+bool FNodeDocsGenerator::SaveClassDoc(FDocGenClassContent const& ClassDoc)
+{
+	if(Settings.bDirectHtmlOutput)
+	{
+		return FHtmlDocRenderer::WritePage(OutputDir / ClassDoc.Id / (ClassDoc.Id + TEXT(".html")), FHtmlDocRenderer::RenderClassPage(ClassDoc));
+	}
+
+	return SaveClassDocXml(ClassDoc, GetClassDocXmlPath(ClassDoc.Id));
+}
+
+FString FNodeDocsGenerator::GetClassDocXmlPath(FString const& ClassId) const
+{
+	if(Settings.bDirectHtmlOutput)
+	{
+		// Only used for reopening class docs, so kept out of the html output
+		return FPaths::ProjectIntermediateDir() / TEXT("KantanDocGen") / DocsTitle / TEXT("FlushedClasses") / (ClassId + TEXT(".xml"));
+	}
 
-	static const uint32 PermittedAccessSpecifiers = (FUNC_Public | FUNC_Protected);
+	return OutputDir / ClassId / (ClassId + TEXT(".xml"));
+}
 
+/*
+Old DOM based serialization, retained only as the baseline for the benchmark below.
+*/
+static void BuildNodeDocXmlFile(FXmlFile& File, FDocGenNodeContent const& Content)
+{
+	auto AppendChild = [](FXmlNode* Parent, FString const& Name)
+	{
+		Parent->AppendChildNode(Name, FString());
+		return Parent->GetChildrenNodes().Last();
+	};
+	auto AppendChildCDATA = [](FXmlNode* Parent, FString const& Name, FString const& TextContent)
+	{
+		Parent->AppendChildNode(Name, TEXT("<![CDATA[") + TextContent + TEXT("]]>"));
+	};
 
-	for(auto ExclSpawnerClass : ExcludedSpawnerClasses)
+	auto Root = File.GetRootNode();
+	AppendChildCDATA(Root, TEXT("docs_name"), Content.DocsName);
+	AppendChildCDATA(Root, TEXT("class_id"), Content.ClassId);
+	AppendChildCDATA(Root, TEXT("class_name"), Content.ClassName);
+	AppendChildCDATA(Root, TEXT("shorttitle"), Content.ShortTitle);
+	AppendChildCDATA(Root, TEXT("fulltitle"), Content.FullTitle);
+	AppendChildCDATA(Root, TEXT("description"), Content.Description);
+	AppendChildCDATA(Root, TEXT("imgpath"), Content.ImgPath);
+	AppendChildCDATA(Root, TEXT("category"), Content.Category);
+
+	auto AppendParams = [&](FXmlNode* Parent, TArray< FDocGenParamContent > const& Params)
 	{
-		if(Spawner->IsA(ExclSpawnerClass))
+		for(auto const& Param : Params)
 		{
-			return false;
+			auto ParamElem = AppendChild(Parent, TEXT("param"));
+			AppendChildCDATA(ParamElem, TEXT("name"), Param.Name);
+			AppendChildCDATA(ParamElem, TEXT("type"), Param.Type);
+			AppendChildCDATA(ParamElem, TEXT("description"), Param.Description);
 		}
+	};
+
+	AppendParams(AppendChild(Root, TEXT("inputs")), Content.Inputs);
+	AppendParams(AppendChild(Root, TEXT("outputs")), Content.Outputs);
+}
+
+void FNodeDocsGenerator::BenchmarkXmlSerialization(FString const& OutputDir, int32 Iterations)
+{
+	Iterations = FMath::Max(Iterations, 1);
+
+	// Representative node with a handful of pins
+	FDocGenNodeContent Content;
+	Content.DocsName = TEXT("Benchmark");
+	Content.ClassId = TEXT("KismetMathLibrary");
+	Content.ClassName = TEXT("Kismet Math Library");
+	Content.Id = TEXT("BenchmarkNode");
+	Content.ShortTitle = TEXT("Make Transform");
+	Content.FullTitle = TEXT("Make Transform\nTarget is Kismet Math Library");
+	Content.Description = TEXT("Make a transform from location, rotation and scale.\nSome ]]> terminator and unicode \u00e9 content.");
+	Content.ImgPath = TEXT("../img/nd_img_BenchmarkNode.png");
+	Content.Category = TEXT("Math|Transform");
+	for(int32 Idx = 0; Idx < 6; ++Idx)
+	{
+		FDocGenParamContent Param;
+		Param.Name = FString::Printf(TEXT("Param%i"), Idx);
+		Param.Type = TEXT("Vector Structure");
+		Param.Description = TEXT("Description of the parameter, spanning a reasonable number of characters.");
+		(Idx < 4 ? Content.Inputs : Content.Outputs).Add(Param);
 	}
 
-	if(bIsBlueprint)
+	const FString FileTemplate = R"xxx(<?xml version="1.0" encoding="UTF-8"?>
+<root></root>)xxx";
+
+	double DomBuildTime = 0.0;
+	double DomSaveTime = 0.0;
+	double WriterBuildTime = 0.0;
+	double WriterSaveTime = 0.0;
+	for(int32 Iteration = 0; Iteration < Iterations; ++Iteration)
 	{
-		for(auto ExclSpawnerClass : BlueprintOnlyExcludedSpawnerClasses)
 		{
-			if(Spawner->IsA(ExclSpawnerClass))
+			FXmlFile File(FileTemplate, EConstructMethod::ConstructFromBuffer);
+			{
+				SCOPE_SECONDS_COUNTER(DomBuildTime);
+				BuildNodeDocXmlFile(File, Content);
+			}
+			SCOPE_SECONDS_COUNTER(DomSaveTime);
+			File.Save(OutputDir / TEXT("XmlFile.xml"));
+		}
+		{
+			auto& Writer = FDocGenXmlWriter::GetThreadWriter();
 			{
-				return false;
+				SCOPE_SECONDS_COUNTER(WriterBuildTime);
+				WriteNodeDocXml(Writer, Content);
 			}
+			SCOPE_SECONDS_COUNTER(WriterSaveTime);
+			Writer.SaveToFile(OutputDir / TEXT("XmlWriter.xml"));
 		}
 	}
 
-	for(auto ExclNodeClass : ExcludedNodeClasses)
+	double const Scale = 1000000.0 / Iterations;
+	UE_LOG(LogKantanDocGen, Display, TEXT("Xml serialization benchmark over %i iterations (average us per node): FXmlFile build %.2f, save %.2f; streaming writer build %.2f, save %.2f."),
+		Iterations, DomBuildTime * Scale, DomSaveTime * Scale, WriterBuildTime * Scale, WriterSaveTime * Scale);
+}
+
+bool FNodeDocsGenerator::SaveIndexHtml(FString const& OutDir)
+{
+	return FHtmlDocRenderer::WritePage(OutDir / TEXT("index.html"), FHtmlDocRenderer::RenderIndexPage(IndexDoc));
+}
+
+void FNodeDocsGenerator::AdjustNodeForSnapshot(UEdGraphNode* Node)
+{
+	// Hide default value box containing 'self' for Target pin
+	if(auto K2_Schema = Cast< UEdGraphSchema_K2 >(Node->GetSchema()))
 	{
-		if(Spawner->NodeClass->IsChildOf(ExclNodeClass))
+		if(auto TargetPin = Node->FindPin(K2_Schema->PN_Self))
 		{
-			return false;
+			TargetPin->bDefaultValueIsIgnored = true;
+		}
+	}
+}
+
+FString FNodeDocsGenerator::GetClassDocId(UClass* Class)
+{
+	return Class->GetName();
+}
+
+FString FNodeDocsGenerator::GetNodeDocId(UEdGraphNode* Node)
+{
+	// @TODO: Not sure this is right thing to use
+	return Node->GetDocumentationExcerptName();
+}
+
+FString FNodeDocsGenerator::GetNodeImageFilename(FString const& NodeId)
+{
+	return FString::Printf(TEXT("nd_img_%s.png"), *NodeId);
+}
+
+bool FNodeDocsGenerator::GT_IsNodeDocumented(FString const& ClassId, FString const& Identity) const
+{
+	FScopeLock Lock(&DocumentedNodesLock);
+	return DocumentedNodes.Contains(ClassId / Identity);
+}
+
+void FNodeDocsGenerator::AbandonNode(FNodeProcessingState const& State)
+{
+	FScopeLock Lock(&DocumentedNodesLock);
+	DocumentedNodes.Remove(State.NodeIdentity);
+}
+
+/*
+Records the node as documented, and claims a doc id for it within its class.
+Doc ids aren't guaranteed to be unique. If the requested one is taken by a different node, it's suffixed with the node
+class and failing that a hash of the identity, rather than letting the later node overwrite the earlier one's doc and
+image. Suffixes depend only on the node itself, so they are the same from run to run and keep manifest keys stable.
+*/
+FString FNodeDocsGenerator::GT_ClaimNodeId(FNodeProcessingState& State, FString const& Identity, FString const& RequestedId)
+{
+	State.NodeIdentity = State.ClassId / Identity;
+	{
+		FScopeLock Lock(&DocumentedNodesLock);
+		DocumentedNodes.Add(State.NodeIdentity);
+	}
+
+	auto IsClaimedByOther = [this, &State, &Identity](FString const& NodeId)
+	{
+		auto Owner = ClaimedNodeIds.Find(State.ClassId / NodeId);
+		return Owner && *Owner != Identity;
+	};
+
+	FString NodeId = RequestedId;
+	if(IsClaimedByOther(NodeId))
+	{
+		// Identities begin with the node class path
+		FString NodeClassPath, NodeClassName;
+		Identity.Split(TEXT("|"), &NodeClassPath, nullptr);
+		if(!NodeClassPath.Split(TEXT("."), nullptr, &NodeClassName, ESearchCase::CaseSensitive, ESearchDir::FromEnd))
+		{
+			NodeClassName = NodeClassPath;
 		}
+
+		NodeId = RequestedId + TEXT("_") + NodeClassName;
+		if(IsClaimedByOther(NodeId))
+		{
+			NodeId = FString::Printf(TEXT("%s_%08x"), *RequestedId, FCrc::StrCrc32(*Identity));
+		}
+
+		++NodeIdCollisionCount;
+		UE_LOG(LogKantanDocGen, Log, TEXT("Node doc id '%s' in class %s is already in use, documenting as '%s'."), *RequestedId, *State.ClassId, *NodeId);
+	}
+
+	ClaimedNodeIds.Add(State.ClassId / NodeId, Identity);
+	return NodeId;
+}
+
+/*
+Stable identities of what a node documents, independent of the spawner or source object it was found through.
+Function calls are identified by the function, other nodes by their class and a hash of their title and pins.
+*/
+FString FNodeDocsGenerator::ComputeFunctionIdentity(UFunction* Func)
+{
+	return UK2Node_CallFunction::StaticClass()->GetPathName() + TEXT("|") + Func->GetPathName();
+}
+
+FString FNodeDocsGenerator::ComputeNodeIdentity(UK2Node* Node)
+{
+	auto FuncNode = Cast< UK2Node_CallFunction >(Node);
+	auto Func = FuncNode ? FuncNode->GetTargetFunction() : nullptr;
+	if(Func && Node->GetClass() == UK2Node_CallFunction::StaticClass())
+	{
+		return ComputeFunctionIdentity(Func);
 	}
 
-	if(auto FuncSpawner = Cast< UBlueprintFunctionNodeSpawner >(Spawner))
+	uint32 Hash = 0;
+	auto Combine = [&Hash](FString const& Str)
 	{
-		auto Func = FuncSpawner->GetFunction();
+		Hash = FCrc::StrCrc32(*Str, HashCombine(Hash, (uint32)Str.Len()));
+	};
+
+	Combine(Func ? Func->GetPathName() : FString());
+	Combine(Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString());
+	for(auto Pin : Node->Pins)
+	{
+		Combine(Pin->PinName.ToString());
+		Combine(Pin->PinType.PinCategory.ToString());
+		Combine(Pin->PinType.PinSubCategory.ToString());
+		Combine(Pin->PinType.PinSubCategoryObject.IsValid() ? Pin->PinType.PinSubCategoryObject->GetPathName() : FString());
+		Hash = HashCombine(Hash, (uint32)Pin->PinType.ContainerType | ((uint32)Pin->Direction << 8) | ((uint32)Pin->bHidden << 16));
+	}
+
+	return FString::Printf(TEXT("%s|%08x"), *Node->GetClass()->GetPathName(), Hash);
+}
+
+/*
+Signature covering everything which affects the generated docs and image for a node.
+*/
+uint32 FNodeDocsGenerator::ComputeFunctionSignature(UFunction* Func, UBlueprintNodeSpawner* Spawner, uint32 SettingsHash)
+{
+	uint32 Signature = SettingsHash;
+	auto Combine = [&Signature](FString const& Str)
+	{
+		Signature = FCrc::StrCrc32(*Str, HashCombine(Signature, (uint32)Str.Len()));
+	};
 
-		// @NOTE: We exclude based on access level, but only if this is not a spawner for a blueprint event
-		// (custom events do not have any access specifiers)
-		if((Func->FunctionFlags & FUNC_BlueprintEvent) == 0 && (Func->FunctionFlags & PermittedAccessSpecifiers) == 0)
+	Combine(Spawner->GetClass()->GetPathName());
+	Combine(Func->GetPathName());
+	Signature = HashCombine(Signature, (uint32)Func->FunctionFlags);
+	if(auto MetaMap = UMetaData::GetMapForObject(Func))
+	{
+		for(auto const& Entry : *MetaMap)
 		{
-			return false;
+			Combine(Entry.Key.ToString());
+			Combine(Entry.Value);
 		}
+	}
 
-		for(auto const& Meta : ExcludedFunctionMeta)
+	for(TFieldIterator< FProperty > It(Func); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+	{
+		Combine(It->GetName());
+		Combine(It->GetCPPType());
+		Signature = HashCombine(Signature, GetTypeHash((uint64)It->PropertyFlags));
+		if(auto MetaMap = It->GetMetaDataMap())
 		{
-			if(Func->HasMetaData(Meta))
+			for(auto const& Entry : *MetaMap)
 			{
-				return false;
+				Combine(Entry.Key.ToString());
+				Combine(Entry.Value);
 			}
 		}
 	}
 
-	return true;
+	return Signature;
+}
+
+uint32 FNodeDocsGenerator::ComputeNodeSignature(UK2Node* Node, UBlueprintNodeSpawner* Spawner, uint32 SettingsHash)
+{
+	uint32 Signature = SettingsHash;
+	auto Combine = [&Signature](FString const& Str)
+	{
+		// Mix in the length so that adjacent strings can't alias one another
+		Signature = FCrc::StrCrc32(*Str, HashCombine(Signature, (uint32)Str.Len()));
+	};
+
+	Combine(Spawner->GetClass()->GetPathName());
+	Combine(Node->GetClass()->GetPathName());
+
+	if(auto FuncNode = Cast< UK2Node_CallFunction >(Node))
+	{
+		if(auto Func = FuncNode->GetTargetFunction())
+		{
+			Combine(Func->GetPathName());
+			Combine(Func->GetMetaData(TEXT("ToolTip")));
+		}
+	}
+
+	Combine(Node->GetNodeTitle(ENodeTitleType::ListView).ToString());
+	Combine(Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString());
+	Combine(Node->GetTooltipText().ToString());
+	Combine(Node->GetMenuCategory().ToString());
+
+	for(auto Pin : Node->Pins)
+	{
+		Combine(Pin->PinName.ToString());
+		Combine(Pin->PinType.PinCategory.ToString());
+		Combine(Pin->PinType.PinSubCategory.ToString());
+		Combine(Pin->PinType.PinSubCategoryObject.IsValid() ? Pin->PinType.PinSubCategoryObject->GetPathName() : FString());
+		Signature = HashCombine(Signature, (uint32)Pin->PinType.ContainerType);
+		Signature = HashCombine(Signature, (uint32)Pin->PinType.bIsReference | ((uint32)Pin->PinType.bIsConst << 1));
+		Signature = HashCombine(Signature, (uint32)Pin->Direction | ((uint32)Pin->bHidden << 8));
+		Combine(Pin->DefaultValue);
+		Combine(Pin->DefaultObject ? Pin->DefaultObject->GetPathName() : FString());
+		Combine(Pin->DefaultTextValue.ToString());
+
+		FString HoverText;
+		Node->GetPinHoverText(*Pin, HoverText);
+		Combine(HoverText);
+	}
+
+	return Signature;
+}
+
+/*
+Key for the image cache, covering everything which affects how a node is rendered.
+*/
+FString FNodeDocsGenerator::ComputeNodeVisualKey(UEdGraphNode* Node)
+{
+	// Bump to invalidate all previously cached images
+	static const int32 ImageCacheVersion = 1;
+
+	FString Description;
+	auto Append = [&Description](FString const& Str)
+	{
+		// Length prefixed so that adjacent strings can't alias one another
+		Description += FString::Printf(TEXT("%i:"), Str.Len());
+		Description += Str;
+	};
+
+	Append(FString::FromInt(ImageCacheVersion));
+	Append(FEngineVersion::Current().ToString());
+	Append(Node->GetClass()->GetPathName());
+	Append(Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString());
+	Append(FString::FromInt((int32)Node->AdvancedPinDisplay));
+
+	for(auto Pin : Node->Pins)
+	{
+		Append(Pin->PinName.ToString());
+		Append(Pin->PinFriendlyName.ToString());
+		Append(Pin->PinType.PinCategory.ToString());
+		Append(Pin->PinType.PinSubCategory.ToString());
+		Append(Pin->PinType.PinSubCategoryObject.IsValid() ? Pin->PinType.PinSubCategoryObject->GetPathName() : FString());
+		Append(FString::Printf(TEXT("%i%i%i%i%i%i"),
+			(int32)Pin->PinType.ContainerType,
+			Pin->PinType.bIsReference ? 1 : 0,
+			Pin->PinType.bIsConst ? 1 : 0,
+			(int32)Pin->Direction,
+			Pin->bHidden ? 1 : 0,
+			Pin->bAdvancedView ? 1 : 0
+		));
+		Append(Pin->DefaultValue);
+		Append(Pin->DefaultObject ? Pin->DefaultObject->GetPathName() : FString());
+		Append(Pin->DefaultTextValue.ToString());
+	}
+
+	FSHA1 Hash;
+	Hash.UpdateWithString(*Description, Description.Len());
+	Hash.Final();
+
+	uint8 Digest[FSHA1::DigestSize];
+	Hash.GetHash(Digest);
+	return BytesToHex(Digest, FSHA1::DigestSize);
+}
+
+bool FNodeDocsGenerator::HasNodeArtifacts(FNodeProcessingState const& State, FString const& NodeId) const
+{
+	auto& FileManager = IFileManager::Get();
+	auto const DocExtension = Settings.bDirectHtmlOutput ? TEXT(".html") : TEXT(".xml");
+	return FileManager.FileExists(*(State.ClassDocsPath / TEXT("nodes") / (NodeId + DocExtension)))
+		&& (!State.bGenerateImage || FileManager.FileExists(*(State.ClassDocsPath / TEXT("img") / GetNodeImageFilename(NodeId))));
+}
+
+void FNodeDocsGenerator::RemoveNodeArtifacts(FString const& ClassId, FString const& NodeId)
+{
+	auto& FileManager = IFileManager::Get();
+	auto const DocExtension = Settings.bDirectHtmlOutput ? TEXT(".html") : TEXT(".xml");
+	FileManager.Delete(*(OutputDir / ClassId / TEXT("nodes") / (NodeId + DocExtension)), false, false, true);
+	FileManager.Delete(*(OutputDir / ClassId / TEXT("img") / GetNodeImageFilename(NodeId)), false, false, true);
+}
+
+
+/*
+This takes a graph node object and attempts to map it to the class which the node conceptually belong to.
+If there is no special mapping for the node, the function determines the class from the source object.
+*/
+UClass* FNodeDocsGenerator::MapToAssociatedClass(UK2Node* NodeInst, UObject* Source)
+{
+	// For nodes derived from UK2Node_CallFunction, associate with the class owning the called function.
+	if(auto FuncNode = Cast< UK2Node_CallFunction >(NodeInst))
+	{
+		auto Func = FuncNode->GetTargetFunction();
+		if(Func)
+		{
+			return Func->GetOwnerClass();
+		}
+	}
+
+	// Default fallback
+	if(auto SourceClass = Cast< UClass >(Source))
+	{
+		return SourceClass;
+	}
+	else if(auto SourceBP = Cast< UBlueprint >(Source))
+	{
+		return SourceBP->GeneratedClass;
+	}
+	else
+	{
+		return nullptr;
+	}
 }
 
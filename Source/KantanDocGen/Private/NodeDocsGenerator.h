@@ -9,6 +9,15 @@
 #include "Modules/ModuleManager.h"
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Async/Future.h"
+#include "HAL/ThreadSafeBool.h"
+#include "RHIGPUReadback.h"
+#include "Runtime/ImageWriteQueue/Public/ImagePixelData.h"
+#include "DocGenSettings.h"
+#include "Output/DocGenContent.h"
+#include "NodeDocRecord.h"
 
 
 class UClass;
@@ -17,74 +26,252 @@ class UEdGraph;
 class UEdGraphNode;
 class UK2Node;
 class UBlueprintNodeSpawner;
-class FXmlFile;
+class UFunction;
+class FDocGenXmlWriter;
+class IImageWriteQueue;
+class FDocGenManifest;
+class FDocGenImageCache;
+class FNodeRenderPool;
 
 class FNodeDocsGenerator
 {
 public:
-	FNodeDocsGenerator()
+	FNodeDocsGenerator():
+		PinTexts(Strings)
 	{}
 	~FNodeDocsGenerator();
 
 public:
+	/* Pixels for a batch of nodes rendered together, shared between the states of all nodes in the batch. */
+	struct FNodeImageAtlas
+	{
+		FIntPoint Size;
+		TArray< FColor > Pixels;
+	};
+
+	/* Node capture copied to a staging texture on the GPU, whose pixels are mapped once the copy has completed. */
+	struct FNodeReadback
+	{
+		// Render thread only once created
+		TUniquePtr< FRHIGPUTextureReadback > GPUReadback;
+		FIntPoint TargetSize;
+		FIntRect Rect;
+		TUniquePtr< TImagePixelData< FColor > > PixelData;
+		TPromise< bool > Promise;
+		// Set on the render thread once the promise has been fulfilled
+		FThreadSafeBool bResolved;
+	};
+
 	struct FNodeProcessingState
 	{
-		TSharedPtr< FXmlFile > ClassDocXml;
+		TSharedPtr< FDocGenClassContent, ESPMode::ThreadSafe > ClassDoc;
+		FString ClassId;
+		FString ClassDisplayName;
 		FString ClassDocsPath;
 		FString RelImageBasePath;
 		FString ImageFilename;
+		TUniquePtr< TImagePixelData< FColor > > PixelData;
+		// When atlas captured, the node's pixels are sliced out of the shared atlas on a worker thread
+		TSharedPtr< FNodeImageAtlas, ESPMode::ThreadSafe > Atlas;
+		FIntRect AtlasRect;
+		// When read back asynchronously, the pixels are taken from here once the readback completes
+		TSharedPtr< FNodeReadback, ESPMode::ThreadSafe > Readback;
+		TFuture< bool > ReadbackResult;
+		bool bGenerateImage;
+		// Node is unchanged since the previous run and its existing artifacts can be reused
+		bool bUpToDate;
+		// Key of the node's appearance in the image cache, and whether an image already exists for it
+		FString ImageCacheKey;
+		bool bImageCached;
+		// Everything needed from a spawned node, so that the node can be released once its image is captured
+		FNodeDocRecord Record;
+		// Identity of what the node documents, qualified by class id
+		FString NodeIdentity;
 
 		FNodeProcessingState():
-			ClassDocXml()
+			ClassDoc()
+			, ClassId()
+			, ClassDisplayName()
 			, ClassDocsPath()
 			, RelImageBasePath()
 			, ImageFilename()
+			, PixelData()
+			, Atlas()
+			, AtlasRect()
+			, Readback()
+			, ReadbackResult()
+			, bGenerateImage(true)
+			, bUpToDate(false)
+			, ImageCacheKey()
+			, bImageCached(false)
+			, Record()
+			, NodeIdentity()
 		{}
+
+		bool NeedsImageCapture() const
+		{
+			return bGenerateImage && !bUpToDate && !bImageCached;
+		}
 	};
 
 public:
 	/** Callable only from game thread */
-	bool GT_Init(FString const& InDocsTitle, FString const& InOutputDir, UClass* BlueprintContextClass = AActor::StaticClass());
+	bool GT_Init(FKantanDocGenSettings const& InSettings, FString const& InOutputDir, FDocGenManifest* InManifest = nullptr);
+	/** Call before spawning each batch of nodes, once all nodes of the previous batch have been captured. */
+	void GT_BeginNodeBatch();
+	/** Spawner is expected to have already passed FDocGenSpawnerIndex filtering. */
 	UK2Node* GT_InitializeForSpawner(UBlueprintNodeSpawner* Spawner, UObject* SourceObject, FNodeProcessingState& OutState);
-	bool GT_Finalize(FString OutputPath);
+	/** Whether the spawner's node can be documented from reflection data alone, without spawning it. */
+	bool CanDocumentByReflection(UBlueprintNodeSpawner* Spawner) const;
+	bool GT_InitializeForFunction(UBlueprintNodeSpawner* Spawner, FNodeProcessingState& OutState);
+	bool GT_CaptureNodeImage(UEdGraphNode* Node, FNodeProcessingState& State);
+	/** Captures a batch of nodes, in a single draw if atlas capture is enabled. OutCaptured receives the success of each. */
+	void GT_CaptureNodeImages(TArray< UEdGraphNode* > const& Nodes, TArray< FNodeProcessingState* > const& States, TArray< bool >& OutCaptured);
+	/** Removes nodes from the graph and unroots them, so they can be garbage collected. */
+	void GT_ReleaseNodes(TArray< UK2Node* > const& Nodes);
+	/** Releases render resources and UObjects once all nodes have been processed. */
+	void GT_Finalize();
 	/**/
 
-	/** Callable from background thread */
-	bool GenerateNodeImage(UEdGraphNode* Node, FNodeProcessingState& State);
-	bool GenerateNodeDocs(UK2Node* Node, FNodeProcessingState& State);
+	/** Callable from background thread, including concurrently for different nodes */
+	bool WriteNodeImage(FNodeProcessingState& State);
+	/**
+	Writes out and releases class docs which have no nodes still in flight. Call between source objects, while no game thread
+	enumeration is in progress. If bForce, all remaining class docs are written. Returns false if any failed to be written.
+	*/
+	bool FlushClassDocs(bool bForce = false);
+	/** Saves all remaining class docs and the index. Call after GT_Finalize. */
+	bool Finalize(FString const& OutputPath);
+	/** Forgets a node which failed to be documented, so that a duplicate of it later in the run gets another chance. */
+	void AbandonNode(FNodeProcessingState const& State);
+	/** Blocks until all queued image writes have completed, returns the number which failed. */
+	int32 FlushImageWrites();
+	/** Works from the state alone, the node it was captured from need not still exist. */
+	bool GenerateNodeDocs(FNodeProcessingState& State);
+	/** Deletes the doc and image files of a node documented in a previous run. */
+	void RemoveNodeArtifacts(FString const& ClassId, FString const& NodeId);
 	/**/
 
+	static FString GetNodeImageFilename(FString const& NodeId);
+
+	/** Version of the artifacts written for each node. Bump on any change to them, so that incremental runs regenerate every node. */
+	static const int32 NodeArtifactVersion = 3;
+
+	int32 GetImageCacheHits() const { return ImageCacheHits.GetValue(); }
+
+	/** Times serialization of a representative node doc with FXmlFile and with the streaming writer. */
+	static void BenchmarkXmlSerialization(FString const& OutputDir, int32 Iterations);
+
+protected:
+	struct FPendingImageWrite
+	{
+		FString NodeName;
+		FString ImagePath;
+		FString CacheKey;
+		TFuture< bool > Result;
+	};
+
 protected:
 	void CleanUp();
-	TSharedPtr< FXmlFile > InitIndexXml(FString const& IndexTitle);
-	TSharedPtr< FXmlFile > InitClassDocXml(UClass* Class);
-	bool UpdateIndexDocWithClass(FXmlFile* DocFile, UClass* Class);
-	bool UpdateClassDocWithNode(FXmlFile* DocFile, UEdGraphNode* Node);
+	void GT_RotateGraph();
+	void GT_PrepareCapture();
+	TSharedPtr< FDocGenClassContent, ESPMode::ThreadSafe > InitClassDoc(UClass* Class);
+	TSharedPtr< FDocGenClassContent, ESPMode::ThreadSafe > OpenClassDoc(UClass* Class);
+	bool UpdateIndexDocWithClass(FDocGenIndexContent& Index, UClass* Class);
+	bool UpdateClassDocWithNode(FDocGenClassContent& ClassDoc, FDocGenNodeContent const& Node);
+	void InitNodeState(UClass* AssociatedClass, FNodeProcessingState& OutState);
+	void GT_CaptureNodeRecord(UK2Node* Node, FString const& NodeId, FNodeDocRecord& OutRecord);
+	bool GT_IsNodeDocumented(FString const& ClassId, FString const& Identity) const;
+	FString GT_ClaimNodeId(FNodeProcessingState& State, FString const& Identity, FString const& RequestedId);
+	/** Params are left to be output directly from the record. */
+	bool BuildNodeDocContent(FNodeDocRecord const& Record, FNodeProcessingState const& State, FDocGenNodeContent& OutContent);
+	bool GT_BuildFunctionDocRecord(UFunction* Func, FString const& NodeId, FNodeDocRecord& OutRecord);
+	bool SaveNodeDocXml(FDocGenNodeContent const& Content, TArray< FDocGenParamRef > const& Inputs, TArray< FDocGenParamRef > const& Outputs, FString const& Path);
 	bool SaveIndexXml(FString const& OutDir);
-	bool SaveClassDocXml(FString const& OutDir);
+	bool SaveIndexHtml(FString const& OutDir);
+	bool SaveClassDoc(FDocGenClassContent const& ClassDoc);
+	bool SaveClassDocXml(FDocGenClassContent const& ClassDoc, FString const& Path);
+	FString GetClassDocXmlPath(FString const& ClassId) const;
+	void TrackImageWrite(FPendingImageWrite&& Write);
+	void CompleteImageWrite(FPendingImageWrite& Write);
+
+	static void WriteIndexXml(FDocGenXmlWriter& Writer, FDocGenIndexContent const& Index);
+	static void WriteClassDocXml(FDocGenXmlWriter& Writer, FDocGenClassContent const& ClassDoc);
+	static void WriteNodeDocXml(FDocGenXmlWriter& Writer, FDocGenNodeContent const& Content);
+	static void WriteNodeDocXml(FDocGenXmlWriter& Writer, FDocGenNodeContent const& Content, TArray< FDocGenParamRef > const& Inputs, TArray< FDocGenParamRef > const& Outputs);
 
 	static void AdjustNodeForSnapshot(UEdGraphNode* Node);
+	static void SliceAtlasImage(FNodeProcessingState& State);
+	bool CompleteReadback(FNodeProcessingState& State);
+	/** Completes readbacks whose copies have finished, waiting on the oldest until no more than MaxOutstanding remain. */
+	void GT_ResolveReadbacks(int32 MaxOutstanding);
+	static void ResolveReadback_RenderThread(FNodeReadback& Readback);
 	static FString GetClassDocId(UClass* Class);
 	static FString GetNodeDocId(UEdGraphNode* Node);
+	static uint32 ComputeFunctionSignature(UFunction* Func, UBlueprintNodeSpawner* Spawner, uint32 SettingsHash);
+	static uint32 ComputeNodeSignature(UK2Node* Node, UBlueprintNodeSpawner* Spawner, uint32 SettingsHash);
+	static FString ComputeNodeVisualKey(UEdGraphNode* Node);
+	static FString ComputeFunctionIdentity(UFunction* Func);
+	static FString ComputeNodeIdentity(UK2Node* Node);
+	bool HasNodeArtifacts(FNodeProcessingState const& State, FString const& NodeId) const;
 	static UClass* MapToAssociatedClass(UK2Node* NodeInst, UObject* Source);
-	static bool IsSpawnerDocumentable(UBlueprintNodeSpawner* Spawner, bool bIsBlueprint);
 
 protected:
 	TWeakObjectPtr< UBlueprint > DummyBP;
+	// Graph currently being spawned into
 	TWeakObjectPtr< UEdGraph > Graph;
+	int32 GraphSpawnCount = 0;
+	int32 GraphRecycleInterval = 512;
+	// Nodes spawned and not yet released for each graph still rooted, including retired ones
+	TMap< UEdGraph*, int32 > LiveNodeCounts;
 	TSharedPtr< class SGraphPanel > GraphPanel;
+	TUniquePtr< FNodeRenderPool > RenderPool;
+	bool bAsyncReadback = false;
+	// Readbacks whose copies have been enqueued but not yet mapped, oldest first
+	TArray< TSharedPtr< FNodeReadback, ESPMode::ThreadSafe > > PendingReadbacks;
+	int32 MaxPendingReadbacks = 1;
+
+	FKantanDocGenSettings Settings;
+	FDocGenManifest* Manifest = nullptr;
+	uint32 SettingsHash = 0;
 
 	FString DocsTitle;
-	TSharedPtr< FXmlFile > IndexXml;
-	TMap< TWeakObjectPtr< UClass >, TSharedPtr< FXmlFile > > ClassDocsMap;
+	FDocGenIndexContent IndexDoc;
+	// Strings of all node records captured during the run
+	FDocGenStringTable Strings;
+	FDocGenPinTextTable PinTexts;
+	// Class docs which can still receive nodes
+	TMap< TWeakObjectPtr< UClass >, TSharedPtr< FDocGenClassContent, ESPMode::ThreadSafe > > ClassDocsMap;
+	// Most recently flushed class docs, kept in memory in case a later source object produces nodes for them
+	TArray< TPair< TWeakObjectPtr< UClass >, TSharedPtr< FDocGenClassContent, ESPMode::ThreadSafe > > > LateClassDocs;
+	TSet< TWeakObjectPtr< UClass > > FlushedClasses;
+	// Identities of nodes documented so far, qualified by class id. Guarded since failures are abandoned from workers.
+	TSet< FString > DocumentedNodes;
+	mutable FCriticalSection DocumentedNodesLock;
+	// Identity of the node which claimed each doc id, with the id qualified by class id
+	TMap< FString, FString > ClaimedNodeIds;
+	int32 DuplicateNodeCount = 0;
+	int32 NodeIdCollisionCount = 0;
+	bool bClassDocWriteFailed = false;
+	// Guards modification of class docs from concurrent node doc generation
+	FCriticalSection ClassDocsLock;
 
 	FString OutputDir;
 
+	IImageWriteQueue* ImageWriteQueue = nullptr;
+	TArray< FPendingImageWrite > PendingImageWrites;
+	int32 MaxPendingImageWrites = 32;
+	FCriticalSection ImageWritesLock;
+	FThreadSafeCounter FailedImageWrites;
+
+	TUniquePtr< FDocGenImageCache > ImageCache;
+	FThreadSafeCounter ImageCacheHits;
+
 public:
-	//
+	// Accumulated across the game thread and workers, guarded by TimingLock
 	double GenerateNodeImageTime = 0.0;
 	double GenerateNodeDocsTime = 0.0;
-	//
+	FCriticalSection TimingLock;
 };
 
 
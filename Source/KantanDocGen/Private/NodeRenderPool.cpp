@@ -0,0 +1,73 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#include "NodeRenderPool.h"
+#include "KantanDocGenLog.h"
+#include "Slate/WidgetRenderer.h"
+#include "Engine/TextureRenderTarget2D.h"
+
+
+FNodeRenderPool::FNodeRenderPool()
+{}
+
+FNodeRenderPool::~FNodeRenderPool()
+{
+	Release();
+}
+
+FWidgetRenderer& FNodeRenderPool::GetRenderer()
+{
+	if(!Renderer.IsValid())
+	{
+		const bool bUseGammaCorrection = false;
+		Renderer = MakeUnique< FWidgetRenderer >(bUseGammaCorrection);
+		Renderer->SetIsPrepassNeeded(true);
+	}
+
+	return *Renderer;
+}
+
+UTextureRenderTarget2D* FNodeRenderPool::GetRenderTarget(FVector2D const& DrawSize)
+{
+	auto const SizeClass = GetSizeClass(DrawSize);
+	if(auto Existing = RenderTargets.Find(SizeClass))
+	{
+		return *Existing;
+	}
+
+	if(DrawSize.X > MaxTargetSize || DrawSize.Y > MaxTargetSize)
+	{
+		UE_LOG(LogKantanDocGen, Warning, TEXT("Node of size %ix%i exceeds maximum render target size, image will be clipped."), (int32)DrawSize.X, (int32)DrawSize.Y);
+	}
+
+	const bool bUseGammaCorrection = false;
+	auto RenderTarget = FWidgetRenderer::CreateTargetFor(FVector2D(SizeClass), TF_Bilinear, bUseGammaCorrection);
+	RenderTarget->AddToRoot();
+	RenderTargets.Add(SizeClass, RenderTarget);
+	return RenderTarget;
+}
+
+void FNodeRenderPool::Release()
+{
+	for(auto& Entry : RenderTargets)
+	{
+		Entry.Value->RemoveFromRoot();
+	}
+	RenderTargets.Empty();
+	Renderer.Reset();
+}
+
+FIntPoint FNodeRenderPool::GetSizeClass(FVector2D const& DrawSize)
+{
+	auto SizeClassFor = [](float Extent)
+	{
+		int32 const Required = FMath::Clamp(FMath::CeilToInt(Extent), MinTargetSize, MaxTargetSize);
+		return (int32)FMath::RoundUpToPowerOfTwo((uint32)Required);
+	};
+
+	return FIntPoint(SizeClassFor(DrawSize.X), SizeClassFor(DrawSize.Y));
+}
+
@@ -0,0 +1,41 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+class FWidgetRenderer;
+class UTextureRenderTarget2D;
+
+/*
+Reusable widget renderer and render targets for node capture.
+Render targets are bucketed by size class (power of two in each dimension), so that nodes of similar size share a target
+rather than each allocating its own. Game thread only.
+*/
+class FNodeRenderPool
+{
+public:
+	FNodeRenderPool();
+	~FNodeRenderPool();
+
+public:
+	FWidgetRenderer& GetRenderer();
+	/** Returns a pooled render target at least as large as DrawSize, up to the maximum supported size. */
+	UTextureRenderTarget2D* GetRenderTarget(FVector2D const& DrawSize);
+	void Release();
+
+	static FIntPoint GetSizeClass(FVector2D const& DrawSize);
+
+	static const int32 MinTargetSize = 64;
+	static const int32 MaxTargetSize = 4096;
+
+protected:
+	TUniquePtr< FWidgetRenderer > Renderer;
+	TMap< FIntPoint, UTextureRenderTarget2D* > RenderTargets;
+};
+
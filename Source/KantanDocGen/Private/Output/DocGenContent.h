@@ -0,0 +1,83 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/*
+Plain data mirroring the contents of the intermediate xml docs, independent of how they are stored.
+*/
+
+struct FDocGenParamContent
+{
+	FString Name;
+	FString Type;
+	FString Description;
+};
+
+/* Param referencing strings owned elsewhere, such as interned strings or an FDocGenParamContent, for output without copying. */
+struct FDocGenParamRef
+{
+	FString const* Name;
+	FString const* Type;
+	FString const* Description;
+
+	FDocGenParamRef(FString const* InName, FString const* InType, FString const* InDescription):
+		Name(InName)
+		, Type(InType)
+		, Description(InDescription)
+	{}
+
+	FDocGenParamRef(FDocGenParamContent const& Param):
+		Name(&Param.Name)
+		, Type(&Param.Type)
+		, Description(&Param.Description)
+	{}
+};
+
+struct FDocGenNodeContent
+{
+	FString DocsName;
+	FString ClassId;
+	FString ClassName;
+	FString Id;
+	FString ShortTitle;
+	FString FullTitle;
+	FString Description;
+	FString ImgPath;
+	FString Category;
+	TArray< FDocGenParamContent > Inputs;
+	TArray< FDocGenParamContent > Outputs;
+};
+
+struct FDocGenNodeRef
+{
+	FString Id;
+	FString ShortTitle;
+};
+
+struct FDocGenClassContent
+{
+	FString DocsName;
+	FString Id;
+	FString DisplayName;
+	TArray< FDocGenNodeRef > Nodes;
+};
+
+struct FDocGenClassRef
+{
+	FString Id;
+	FString DisplayName;
+};
+
+struct FDocGenIndexContent
+{
+	FString DisplayName;
+	TArray< FDocGenClassRef > Classes;
+};
+
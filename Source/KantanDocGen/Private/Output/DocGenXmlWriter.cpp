@@ -0,0 +1,130 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#include "DocGenXmlWriter.h"
+#include "KantanDocGenLog.h"
+#include "Misc/FileHelper.h"
+#include "Containers/StringConv.h"
+
+
+void FDocGenXmlWriter::Reset()
+{
+	Buffer.Reset();
+	OpenElements.Reset();
+
+	WriteAscii("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+}
+
+void FDocGenXmlWriter::BeginElement(TCHAR const* Name)
+{
+	OnChildElement();
+	WriteIndent();
+	WriteAscii("<");
+	WriteText(Name, FCString::Strlen(Name));
+	WriteAscii(">");
+
+	OpenElements.Add(FOpenElement{ Name, false });
+}
+
+void FDocGenXmlWriter::EndElement()
+{
+	check(OpenElements.Num() > 0);
+	auto const Element = OpenElements.Pop(false);
+
+	// Empty elements are closed on the same line
+	if(Element.bHasChildren)
+	{
+		WriteIndent();
+	}
+	WriteAscii("</");
+	WriteText(Element.Name, FCString::Strlen(Element.Name));
+	WriteAscii(">\n");
+}
+
+void FDocGenXmlWriter::WriteCDATAElement(TCHAR const* Name, FString const& Text)
+{
+	OnChildElement();
+	WriteIndent();
+	WriteAscii("<");
+	WriteText(Name, FCString::Strlen(Name));
+	WriteAscii("><![CDATA[");
+
+	// A CDATA section can't contain its own terminator, so any ']]>' is split across two sections
+	TCHAR const* Start = *Text;
+	TCHAR const* End = Start + Text.Len();
+	TCHAR const* Cursor = Start;
+	while(Cursor + 2 < End)
+	{
+		if(Cursor[0] == TEXT(']') && Cursor[1] == TEXT(']') && Cursor[2] == TEXT('>'))
+		{
+			WriteText(Start, (int32)(Cursor - Start) + 2);
+			WriteAscii("]]><![CDATA[");
+			Start = Cursor + 2;
+			Cursor += 2;
+			continue;
+		}
+		++Cursor;
+	}
+	WriteText(Start, (int32)(End - Start));
+
+	WriteAscii("]]></");
+	WriteText(Name, FCString::Strlen(Name));
+	WriteAscii(">\n");
+}
+
+bool FDocGenXmlWriter::SaveToFile(FString const& Path) const
+{
+	if(!FFileHelper::SaveArrayToFile(Buffer, *Path))
+	{
+		UE_LOG(LogKantanDocGen, Error, TEXT("Failed to write xml file '%s'."), *Path);
+		return false;
+	}
+
+	return true;
+}
+
+FDocGenXmlWriter& FDocGenXmlWriter::GetThreadWriter()
+{
+	static thread_local FDocGenXmlWriter Writer;
+	Writer.Reset();
+	return Writer;
+}
+
+void FDocGenXmlWriter::WriteIndent()
+{
+	int32 const Depth = OpenElements.Num();
+	int32 const Offset = Buffer.AddUninitialized(Depth);
+	FMemory::Memset(Buffer.GetData() + Offset, '\t', Depth);
+}
+
+void FDocGenXmlWriter::WriteAscii(ANSICHAR const* Str, int32 Len)
+{
+	int32 const Offset = Buffer.AddUninitialized(Len);
+	FMemory::Memcpy(Buffer.GetData() + Offset, Str, Len);
+}
+
+void FDocGenXmlWriter::WriteText(TCHAR const* Str, int32 Len)
+{
+	if(Len <= 0)
+	{
+		return;
+	}
+
+	// Encode directly into the buffer, avoiding an intermediate conversion allocation
+	int32 const EncodedLen = FTCHARToUTF8_Convert::ConvertedLength(Str, Len);
+	int32 const Offset = Buffer.AddUninitialized(EncodedLen);
+	FTCHARToUTF8_Convert::Convert((ANSICHAR*)(Buffer.GetData() + Offset), EncodedLen, Str, Len);
+}
+
+void FDocGenXmlWriter::OnChildElement()
+{
+	if(OpenElements.Num() > 0 && !OpenElements.Last().bHasChildren)
+	{
+		OpenElements.Last().bHasChildren = true;
+		WriteAscii("\n");
+	}
+}
+
@@ -0,0 +1,66 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+/*
+Append only xml writer, encoding UTF-8 straight into a byte buffer without building any document tree.
+Reset keeps the buffer's allocation, so a single writer can be reused for many documents.
+Output layout matches that of FXmlFile::Save, with all text content written as CDATA.
+*/
+class FDocGenXmlWriter
+{
+public:
+	FDocGenXmlWriter()
+	{
+		Reset();
+	}
+
+public:
+	/** Starts a new document, retaining the buffer allocation. */
+	void Reset();
+
+	void BeginElement(TCHAR const* Name);
+	void EndElement();
+	/** Writes a complete element with the given text wrapped as CDATA. */
+	void WriteCDATAElement(TCHAR const* Name, FString const& Text);
+
+	TArray< uint8 > const& GetBuffer() const
+	{
+		return Buffer;
+	}
+
+	bool SaveToFile(FString const& Path) const;
+
+	/** Writer for use by the calling thread, so concurrent node serialization doesn't contend or reallocate. */
+	static FDocGenXmlWriter& GetThreadWriter();
+
+protected:
+	void WriteIndent();
+	void WriteAscii(ANSICHAR const* Str, int32 Len);
+	void WriteText(TCHAR const* Str, int32 Len);
+	void OnChildElement();
+
+	template < int32 N >
+	void WriteAscii(ANSICHAR const (&Str)[N])
+	{
+		WriteAscii(Str, N - 1);
+	}
+
+protected:
+	struct FOpenElement
+	{
+		TCHAR const* Name;
+		bool bHasChildren;
+	};
+
+	TArray< uint8 > Buffer;
+	TArray< FOpenElement > OpenElements;
+};
+
@@ -0,0 +1,381 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#include "HtmlDocRenderer.h"
+#include "IntermediateDocReader.h"
+#include "KantanDocGenLog.h"
+#include "Interfaces/IPluginManager.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Async/ParallelFor.h"
+
+
+namespace
+{
+	FString EscapeText(FString const& Text)
+	{
+		FString Result;
+		Result.Reserve(Text.Len());
+		for(auto Ch : Text)
+		{
+			switch(Ch)
+			{
+				case TEXT('&'): Result += TEXT("&amp;"); break;
+				case TEXT('<'): Result += TEXT("&lt;"); break;
+				case TEXT('>'): Result += TEXT("&gt;"); break;
+				default: Result.AppendChar(Ch); break;
+			}
+		}
+		return Result;
+	}
+
+	FString EscapeAttribute(FString const& Text)
+	{
+		FString Result;
+		Result.Reserve(Text.Len());
+		for(auto Ch : Text)
+		{
+			switch(Ch)
+			{
+				case TEXT('&'): Result += TEXT("&amp;"); break;
+				case TEXT('<'): Result += TEXT("&lt;"); break;
+				case TEXT('"'): Result += TEXT("&quot;"); break;
+				default: Result.AppendChar(Ch); break;
+			}
+		}
+		return Result;
+	}
+
+	/*
+	Equivalent of the text() template and 'repNL' in node_docs_xform.xsl.
+	Whitespace only text produces nothing, otherwise leading and trailing whitespace is stripped and newlines become line breaks.
+	*/
+	FString RepNL(FString const& Text)
+	{
+		int32 Start = 0;
+		int32 End = Text.Len();
+		while(Start < End && FChar::IsWhitespace(Text[Start]))
+		{
+			++Start;
+		}
+		while(End > Start && FChar::IsWhitespace(Text[End - 1]))
+		{
+			--End;
+		}
+
+		TArray< FString > Lines;
+		Text.Mid(Start, End - Start).ParseIntoArray(Lines, TEXT("\n"), false);
+
+		FString Result;
+		for(int32 Idx = 0; Idx < Lines.Num(); ++Idx)
+		{
+			if(Idx > 0)
+			{
+				Result += TEXT("<br>");
+			}
+			Result += EscapeText(Lines[Idx]);
+		}
+		return Result;
+	}
+
+	FString PageHeader(FString const& Title, TCHAR const* StylesheetPath)
+	{
+		return FString::Printf(TEXT(
+			"<!DOCTYPE html>\n"
+			"<html>\n"
+			"\t<head>\n"
+			"\t\t<meta http-equiv=\"Content-Type\" content=\"text/html; charset=UTF-8\">\n"
+			"\t\t<title>%s</title>\n"
+			"\t\t<link rel=\"stylesheet\" type=\"text/css\" href=\"%s\">\n"
+			"\t</head>\n"
+			"\t<body>\n"
+			"\t\t<div id=\"content_container\">\n"),
+			*EscapeText(Title),
+			StylesheetPath
+		);
+	}
+
+	FString PageFooter()
+	{
+		return TEXT(
+			"\t\t</div>\n"
+			"\t</body>\n"
+			"</html>\n");
+	}
+
+	void RenderParams(FString& Html, TCHAR const* Heading, TArray< FDocGenParamRef > const& Params)
+	{
+		Html += FString::Printf(TEXT("\t\t\t<h3 class=\"title_style\">%s</h3>\n"), Heading);
+		Html += TEXT(
+			"\t\t\t<table>\n"
+			"\t\t\t\t<colgroup>\n"
+			"\t\t\t\t\t<col width=\"25%\">\n"
+			"\t\t\t\t\t<col width=\"75%\">\n"
+			"\t\t\t\t</colgroup>\n"
+			"\t\t\t\t<tbody>\n");
+
+		for(auto const& Param : Params)
+		{
+			Html += FString::Printf(TEXT(
+				"\t\t\t\t\t<tr>\n"
+				"\t\t\t\t\t\t<td>\n"
+				"\t\t\t\t\t\t\t<div class=\"param_name title_style\">%s</div>\n"
+				"\t\t\t\t\t\t\t<div class=\"param_type\">%s</div>\n"
+				"\t\t\t\t\t\t</td>\n"
+				"\t\t\t\t\t\t<td>\n"
+				"\t\t\t\t\t\t\t<p>%s</p>\n"
+				"\t\t\t\t\t\t</td>\n"
+				"\t\t\t\t\t</tr>\n"),
+				*RepNL(*Param.Name),
+				*RepNL(*Param.Type),
+				*RepNL(*Param.Description)
+			);
+		}
+
+		Html += TEXT(
+			"\t\t\t\t</tbody>\n"
+			"\t\t\t</table>\n");
+	}
+}
+
+
+FString FHtmlDocRenderer::RenderIndexPage(FDocGenIndexContent const& Index)
+{
+	auto Classes = Index.Classes;
+	Classes.StableSort([](FDocGenClassRef const& A, FDocGenClassRef const& B)
+	{
+		return A.DisplayName.Compare(B.DisplayName, ESearchCase::CaseSensitive) < 0;
+	});
+
+	FString Html = PageHeader(Index.DisplayName, TEXT("./css/bpdoc.css"));
+	Html += FString::Printf(TEXT("\t\t\t<a class=\"navbar_style\">%s</a>\n"), *EscapeText(Index.DisplayName));
+	Html += FString::Printf(TEXT("\t\t\t<h1 class=\"title_style\">%s</h1>\n"), *EscapeText(Index.DisplayName));
+	Html += TEXT(
+		"\t\t\t<h2 class=\"title_style\">Classes</h2>\n"
+		"\t\t\t<table>\n"
+		"\t\t\t\t<tbody>\n");
+
+	for(auto const& Class : Classes)
+	{
+		Html += FString::Printf(TEXT("\t\t\t\t\t<tr>\n\t\t\t\t\t\t<td><a href=\"./%s/%s.html\">%s</a></td>\n\t\t\t\t\t</tr>\n"),
+			*EscapeAttribute(Class.Id),
+			*EscapeAttribute(Class.Id),
+			*EscapeText(Class.DisplayName)
+		);
+	}
+
+	Html += TEXT(
+		"\t\t\t\t</tbody>\n"
+		"\t\t\t</table>\n");
+	Html += PageFooter();
+	return Html;
+}
+
+FString FHtmlDocRenderer::RenderClassPage(FDocGenClassContent const& Class)
+{
+	auto Nodes = Class.Nodes;
+	Nodes.StableSort([](FDocGenNodeRef const& A, FDocGenNodeRef const& B)
+	{
+		return A.ShortTitle.Compare(B.ShortTitle, ESearchCase::CaseSensitive) < 0;
+	});
+
+	FString Html = PageHeader(Class.DisplayName, TEXT("../css/bpdoc.css"));
+	Html += FString::Printf(TEXT("\t\t\t<a class=\"navbar_style\" href=\"../index.html\">%s</a>\n"), *EscapeText(Class.DocsName));
+	Html += TEXT("\t\t\t<a class=\"navbar_style\">&gt;</a>\n");
+	Html += FString::Printf(TEXT("\t\t\t<a class=\"navbar_style\">%s</a>\n"), *EscapeText(Class.DisplayName));
+	Html += FString::Printf(TEXT("\t\t\t<h1 class=\"title_style\">%s</h1>\n"), *EscapeText(Class.DisplayName));
+	Html += TEXT(
+		"\t\t\t<h2 class=\"title_style\">Nodes</h2>\n"
+		"\t\t\t<table>\n"
+		"\t\t\t\t<tbody>\n");
+
+	for(auto const& Node : Nodes)
+	{
+		Html += FString::Printf(TEXT("\t\t\t\t\t<tr>\n\t\t\t\t\t\t<td><a href=\"./nodes/%s.html\">%s</a></td>\n\t\t\t\t\t</tr>\n"),
+			*EscapeAttribute(Node.Id),
+			*EscapeText(Node.ShortTitle)
+		);
+	}
+
+	Html += TEXT(
+		"\t\t\t\t</tbody>\n"
+		"\t\t\t</table>\n");
+	Html += PageFooter();
+	return Html;
+}
+
+FString FHtmlDocRenderer::RenderNodePage(FDocGenNodeContent const& Node)
+{
+	return RenderNodePage(Node, TArray< FDocGenParamRef >(Node.Inputs), TArray< FDocGenParamRef >(Node.Outputs));
+}
+
+FString FHtmlDocRenderer::RenderNodePage(FDocGenNodeContent const& Node, TArray< FDocGenParamRef > const& Inputs, TArray< FDocGenParamRef > const& Outputs)
+{
+	FString Html = PageHeader(Node.ShortTitle, TEXT("../../css/bpdoc.css"));
+	Html += FString::Printf(TEXT("\t\t\t<a class=\"navbar_style\" href=\"../../index.html\">%s</a>\n"), *EscapeText(Node.DocsName));
+	Html += TEXT("\t\t\t<a class=\"navbar_style\">&gt;</a>\n");
+	Html += FString::Printf(TEXT("\t\t\t<a class=\"navbar_style\" href=\"../%s.html\">%s</a>\n"), *EscapeAttribute(Node.ClassId), *EscapeText(Node.ClassName));
+	Html += TEXT("\t\t\t<a class=\"navbar_style\">&gt;</a>\n");
+	Html += FString::Printf(TEXT("\t\t\t<a class=\"navbar_style\">%s</a>\n"), *EscapeText(Node.ShortTitle));
+
+	// Remaining elements in intermediate document order. docs_name, class_id, class_name, fulltitle and category produce no output.
+	Html += FString::Printf(TEXT("\t\t\t<h1 class=\"title_style\">%s</h1>\n"), *RepNL(Node.ShortTitle));
+	Html += FString::Printf(TEXT("\t\t\t<p>%s</p>\n"), *RepNL(Node.Description));
+	// Always present in the intermediate xml, so emitted even without an image just as the transform does
+	Html += FString::Printf(TEXT("\t\t\t<img src=\"%s\">\n"), *EscapeAttribute(Node.ImgPath.TrimStartAndEnd()));
+	RenderParams(Html, TEXT("Inputs"), Inputs);
+	RenderParams(Html, TEXT("Outputs"), Outputs);
+
+	Html += PageFooter();
+	return Html;
+}
+
+bool FHtmlDocRenderer::WritePage(FString const& Path, FString const& Html)
+{
+	if(!FFileHelper::SaveStringToFile(Html, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogKantanDocGen, Error, TEXT("Failed to write html page '%s'."), *Path);
+		return false;
+	}
+
+	return true;
+}
+
+bool FHtmlDocRenderer::CopyStylesheet(FString const& DocsOutputDir)
+{
+	auto Plugin = IPluginManager::Get().FindPlugin(TEXT("KantanDocGen"));
+	if(!Plugin.IsValid())
+	{
+		UE_LOG(LogKantanDocGen, Error, TEXT("Failed to locate plugin info"));
+		return false;
+	}
+
+	const FString SourcePath = Plugin->GetBaseDir() / TEXT("ThirdParty") / TEXT("KantanDocGenTool") / TEXT("css") / TEXT("bpdoc.css");
+	const FString DestPath = DocsOutputDir / TEXT("css") / TEXT("bpdoc.css");
+	if(IFileManager::Get().Copy(*DestPath, *SourcePath, true, true) != COPY_OK)
+	{
+		UE_LOG(LogKantanDocGen, Error, TEXT("Failed to copy stylesheet to '%s'."), *DestPath);
+		return false;
+	}
+
+	return true;
+}
+
+int32 FHtmlDocRenderer::ConvertIntermediateDocs(FString const& IntermediateDir, FString const& OutputDir, FString const& DocTitle, bool bCleanOutput, bool bSkipUnchangedNodes)
+{
+	const FString DocsOutputDir = OutputDir / DocTitle;
+
+	if(bCleanOutput)
+	{
+		IFileManager::Get().DeleteDirectory(*DocsOutputDir, false, true);
+	}
+
+	FDocGenIndexContent Index;
+	if(!FIntermediateDocReader::ReadIndex(IntermediateDir / TEXT("index.xml"), Index))
+	{
+		return -1;
+	}
+
+	if(!WritePage(DocsOutputDir / TEXT("index.html"), RenderIndexPage(Index)) || !CopyStylesheet(DocsOutputDir))
+	{
+		return -2;
+	}
+
+	FThreadSafeCounter ErrorCount;
+	FThreadSafeCounter WriteFailureCount;
+
+	// Class pages, gathering up the nodes to convert as we go
+	TArray< TArray< FString > > ClassNodeIds;
+	ClassNodeIds.SetNum(Index.Classes.Num());
+
+	ParallelFor(Index.Classes.Num(), [&](int32 ClassIdx)
+	{
+		auto const& ClassId = Index.Classes[ClassIdx].Id;
+		auto const ClassIntermediateDir = IntermediateDir / ClassId;
+		auto const ClassOutputDir = DocsOutputDir / ClassId;
+
+		FDocGenClassContent Class;
+		if(!FIntermediateDocReader::ReadClass(ClassIntermediateDir / (ClassId + TEXT(".xml")), Class))
+		{
+			ErrorCount.Increment();
+			return;
+		}
+
+		if(!WritePage(ClassOutputDir / (ClassId + TEXT(".html")), RenderClassPage(Class)))
+		{
+			WriteFailureCount.Increment();
+			return;
+		}
+
+		auto& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		auto const ImgDir = ClassIntermediateDir / TEXT("img");
+		if(PlatformFile.DirectoryExists(*ImgDir) && !PlatformFile.CopyDirectoryTree(*(ClassOutputDir / TEXT("img")), *ImgDir, true))
+		{
+			UE_LOG(LogKantanDocGen, Error, TEXT("Failed to copy node images for class '%s'."), *ClassId);
+			WriteFailureCount.Increment();
+		}
+
+		for(auto const& Node : Class.Nodes)
+		{
+			ClassNodeIds[ClassIdx].Add(Node.Id);
+		}
+	});
+
+	// Node pages
+	TArray< TPair< FString, FString > > NodeJobs;
+	for(int32 ClassIdx = 0; ClassIdx < Index.Classes.Num(); ++ClassIdx)
+	{
+		for(auto const& NodeId : ClassNodeIds[ClassIdx])
+		{
+			NodeJobs.Emplace(Index.Classes[ClassIdx].Id, NodeId);
+		}
+	}
+
+	FThreadSafeCounter SkippedCount;
+	ParallelFor(NodeJobs.Num(), [&](int32 JobIdx)
+	{
+		auto const& ClassId = NodeJobs[JobIdx].Key;
+		auto const& NodeId = NodeJobs[JobIdx].Value;
+		auto const XmlPath = IntermediateDir / ClassId / TEXT("nodes") / (NodeId + TEXT(".xml"));
+		auto const HtmlPath = DocsOutputDir / ClassId / TEXT("nodes") / (NodeId + TEXT(".html"));
+
+		if(bSkipUnchangedNodes)
+		{
+			auto& FileManager = IFileManager::Get();
+			auto const HtmlTimestamp = FileManager.GetTimeStamp(*HtmlPath);
+			if(HtmlTimestamp != FDateTime::MinValue() && HtmlTimestamp >= FileManager.GetTimeStamp(*XmlPath))
+			{
+				SkippedCount.Increment();
+				return;
+			}
+		}
+
+		FDocGenNodeContent Node;
+		if(!FIntermediateDocReader::ReadNode(XmlPath, Node))
+		{
+			ErrorCount.Increment();
+			return;
+		}
+
+		if(!WritePage(HtmlPath, RenderNodePage(Node)))
+		{
+			WriteFailureCount.Increment();
+		}
+	});
+
+	UE_LOG(LogKantanDocGen, Log, TEXT("Converted %i classes and %i nodes to html (%i unchanged nodes skipped)."), Index.Classes.Num(), NodeJobs.Num() - SkippedCount.GetValue(), SkippedCount.GetValue());
+
+	if(WriteFailureCount.GetValue() > 0)
+	{
+		return -2;
+	}
+
+	return ErrorCount.GetValue();
+}
+
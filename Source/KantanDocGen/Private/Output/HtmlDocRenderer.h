@@ -0,0 +1,40 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#pragma once
+
+#include "DocGenContent.h"
+
+
+/*
+Native html output, reproducing the transforms in ThirdParty/KantanDocGenTool/xslt without needing the external tool.
+Elements, attributes and text match the tool's html serialization. Indentation and the document head (doctype and
+charset declaration) differ, so pages are equivalent but not byte identical.
+*/
+class FHtmlDocRenderer
+{
+public:
+	/** Equivalent of index_xform.xsl */
+	static FString RenderIndexPage(FDocGenIndexContent const& Index);
+	/** Equivalent of class_docs_xform.xsl */
+	static FString RenderClassPage(FDocGenClassContent const& Class);
+	/** Equivalent of node_docs_xform.xsl */
+	static FString RenderNodePage(FDocGenNodeContent const& Node);
+	/** As above, with params taken from Inputs and Outputs in place of those of the node. */
+	static FString RenderNodePage(FDocGenNodeContent const& Node, TArray< FDocGenParamRef > const& Inputs, TArray< FDocGenParamRef > const& Outputs);
+
+	static bool WritePage(FString const& Path, FString const& Html);
+	static bool CopyStylesheet(FString const& DocsOutputDir);
+
+	/**
+	Converts a full intermediate xml tree into html under OutputDir/DocTitle, with class and node pages rendered in parallel.
+	Return codes match those of the external KantanDocGen tool: 0 on success, -1 on failure, -2 on failure to write output,
+	or otherwise the number of pages which could not be converted.
+	If bSkipUnchangedNodes is set, node pages which are newer than their intermediate xml are left as they are.
+	*/
+	static int32 ConvertIntermediateDocs(FString const& IntermediateDir, FString const& OutputDir, FString const& DocTitle, bool bCleanOutput, bool bSkipUnchangedNodes = false);
+};
+
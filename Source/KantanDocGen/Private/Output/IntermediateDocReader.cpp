@@ -0,0 +1,365 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#include "IntermediateDocReader.h"
+#include "KantanDocGenLog.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+
+namespace
+{
+	struct FDocXmlElement
+	{
+		FString Name;
+		// Concatenation of all text and CDATA content directly inside this element
+		FString Text;
+		TArray< FDocXmlElement > Children;
+
+		FDocXmlElement const* FindChild(TCHAR const* ChildName) const
+		{
+			return Children.FindByPredicate([ChildName](FDocXmlElement const& Child)
+			{
+				return Child.Name == ChildName;
+			});
+		}
+
+		FString ChildText(TCHAR const* ChildName) const
+		{
+			auto Child = FindChild(ChildName);
+			return Child ? Child->Text : FString();
+		}
+	};
+
+	const TPair< TCHAR const*, TCHAR > NamedEntities[] = {
+		{ TEXT("lt"), TEXT('<') },
+		{ TEXT("gt"), TEXT('>') },
+		{ TEXT("amp"), TEXT('&') },
+		{ TEXT("quot"), TEXT('"') },
+		{ TEXT("apos"), TEXT('\'') },
+	};
+
+	class FDocXmlParser
+	{
+	public:
+		explicit FDocXmlParser(FString const& InSource):
+			Source(InSource)
+			, Pos(0)
+		{
+			// As per the xml spec, line endings are normalized before parsing
+			Source.ReplaceInline(TEXT("\r\n"), TEXT("\n"), ESearchCase::CaseSensitive);
+		}
+
+		bool Parse(FDocXmlElement& OutRoot)
+		{
+			SkipMisc();
+			return ParseElement(OutRoot);
+		}
+
+	private:
+		bool AtEnd() const
+		{
+			return Pos >= Source.Len();
+		}
+
+		bool LookingAt(TCHAR const* Str) const
+		{
+			return FCString::Strncmp(*Source + Pos, Str, FCString::Strlen(Str)) == 0;
+		}
+
+		bool SkipPast(TCHAR const* Terminator)
+		{
+			auto const Idx = Source.Find(Terminator, ESearchCase::CaseSensitive, ESearchDir::FromStart, Pos);
+			if(Idx == INDEX_NONE)
+			{
+				Pos = Source.Len();
+				return false;
+			}
+
+			Pos = Idx + FCString::Strlen(Terminator);
+			return true;
+		}
+
+		// Skips whitespace, processing instructions, comments and doctype declarations
+		void SkipMisc()
+		{
+			while(!AtEnd())
+			{
+				if(FChar::IsWhitespace(Source[Pos]))
+				{
+					++Pos;
+				}
+				else if(LookingAt(TEXT("<?")))
+				{
+					SkipPast(TEXT("?>"));
+				}
+				else if(LookingAt(TEXT("<!--")))
+				{
+					SkipPast(TEXT("-->"));
+				}
+				else if(LookingAt(TEXT("<!DOCTYPE")))
+				{
+					SkipPast(TEXT(">"));
+				}
+				else
+				{
+					break;
+				}
+			}
+		}
+
+		bool ParseElement(FDocXmlElement& Elem)
+		{
+			if(AtEnd() || Source[Pos] != TEXT('<'))
+			{
+				return false;
+			}
+			++Pos;
+
+			auto const NameStart = Pos;
+			while(!AtEnd() && !FChar::IsWhitespace(Source[Pos]) && Source[Pos] != TEXT('>') && Source[Pos] != TEXT('/'))
+			{
+				++Pos;
+			}
+			Elem.Name = Source.Mid(NameStart, Pos - NameStart);
+
+			// Attributes are not used in the intermediate format, skip to the end of the tag
+			auto const TagEnd = Source.Find(TEXT(">"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Pos);
+			if(Elem.Name.IsEmpty() || TagEnd == INDEX_NONE)
+			{
+				return false;
+			}
+			Pos = TagEnd + 1;
+
+			if(Source[TagEnd - 1] == TEXT('/'))
+			{
+				// Self closing
+				return true;
+			}
+
+			while(!AtEnd())
+			{
+				if(LookingAt(TEXT("</")))
+				{
+					return SkipPast(TEXT(">"));
+				}
+				else if(LookingAt(TEXT("<![CDATA[")))
+				{
+					auto const ContentStart = Pos + 9;
+					auto const ContentEnd = Source.Find(TEXT("]]>"), ESearchCase::CaseSensitive, ESearchDir::FromStart, ContentStart);
+					if(ContentEnd == INDEX_NONE)
+					{
+						return false;
+					}
+
+					Elem.Text += Source.Mid(ContentStart, ContentEnd - ContentStart);
+					Pos = ContentEnd + 3;
+				}
+				else if(LookingAt(TEXT("<!--")))
+				{
+					SkipPast(TEXT("-->"));
+				}
+				else if(LookingAt(TEXT("<?")))
+				{
+					SkipPast(TEXT("?>"));
+				}
+				else if(Source[Pos] == TEXT('<'))
+				{
+					auto const ChildIdx = Elem.Children.AddDefaulted();
+					if(!ParseElement(Elem.Children[ChildIdx]))
+					{
+						return false;
+					}
+				}
+				else
+				{
+					auto const TextStart = Pos;
+					while(!AtEnd() && Source[Pos] != TEXT('<'))
+					{
+						++Pos;
+					}
+					AppendDecodedText(Elem.Text, TextStart, Pos);
+				}
+			}
+
+			// Ran out of input before the closing tag
+			return false;
+		}
+
+		void AppendDecodedText(FString& Out, int32 Start, int32 End) const
+		{
+			for(int32 Idx = Start; Idx < End; ++Idx)
+			{
+				auto const Ch = Source[Idx];
+				if(Ch == TEXT('&'))
+				{
+					auto const Semi = Source.Find(TEXT(";"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Idx);
+					if(Semi != INDEX_NONE && Semi < End)
+					{
+						auto const Entity = Source.Mid(Idx + 1, Semi - Idx - 1);
+						TCHAR Decoded = 0;
+						if(Entity.StartsWith(TEXT("#x")))
+						{
+							Decoded = (TCHAR)FParse::HexNumber(*Entity.Mid(2));
+						}
+						else if(Entity.StartsWith(TEXT("#")))
+						{
+							Decoded = (TCHAR)FCString::Atoi(*Entity.Mid(1));
+						}
+						else
+						{
+							for(auto const& Named : NamedEntities)
+							{
+								if(Entity == Named.Key)
+								{
+									Decoded = Named.Value;
+									break;
+								}
+							}
+						}
+
+						if(Decoded != 0)
+						{
+							Out.AppendChar(Decoded);
+							Idx = Semi;
+							continue;
+						}
+					}
+				}
+
+				Out.AppendChar(Ch);
+			}
+		}
+
+	private:
+		FString Source;
+		int32 Pos;
+	};
+
+	bool LoadDocXml(FString const& Path, FDocXmlElement& OutRoot)
+	{
+		FString Source;
+		if(!FFileHelper::LoadFileToString(Source, *Path))
+		{
+			UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to load intermediate doc file '%s'."), *Path);
+			return false;
+		}
+
+		FDocXmlParser Parser(Source);
+		if(!Parser.Parse(OutRoot) || OutRoot.Name != TEXT("root"))
+		{
+			UE_LOG(LogKantanDocGen, Warning, TEXT("Failed to parse intermediate doc file '%s'."), *Path);
+			return false;
+		}
+
+		return true;
+	}
+
+	void ReadParams(FDocXmlElement const* ParamList, TArray< FDocGenParamContent >& OutParams)
+	{
+		if(ParamList == nullptr)
+		{
+			return;
+		}
+
+		for(auto const& Elem : ParamList->Children)
+		{
+			if(Elem.Name == TEXT("param"))
+			{
+				FDocGenParamContent Param;
+				Param.Name = Elem.ChildText(TEXT("name"));
+				Param.Type = Elem.ChildText(TEXT("type"));
+				Param.Description = Elem.ChildText(TEXT("description"));
+				OutParams.Add(MoveTemp(Param));
+			}
+		}
+	}
+}
+
+
+bool FIntermediateDocReader::ReadIndex(FString const& Path, FDocGenIndexContent& OutIndex)
+{
+	FDocXmlElement Root;
+	if(!LoadDocXml(Path, Root))
+	{
+		return false;
+	}
+
+	OutIndex.DisplayName = Root.ChildText(TEXT("display_name"));
+	OutIndex.Classes.Reset();
+	if(auto Classes = Root.FindChild(TEXT("classes")))
+	{
+		for(auto const& Elem : Classes->Children)
+		{
+			if(Elem.Name == TEXT("class"))
+			{
+				FDocGenClassRef Class;
+				Class.Id = Elem.ChildText(TEXT("id"));
+				Class.DisplayName = Elem.ChildText(TEXT("display_name"));
+				OutIndex.Classes.Add(MoveTemp(Class));
+			}
+		}
+	}
+
+	return true;
+}
+
+bool FIntermediateDocReader::ReadClass(FString const& Path, FDocGenClassContent& OutClass)
+{
+	FDocXmlElement Root;
+	if(!LoadDocXml(Path, Root))
+	{
+		return false;
+	}
+
+	OutClass.DocsName = Root.ChildText(TEXT("docs_name"));
+	OutClass.Id = Root.ChildText(TEXT("id"));
+	OutClass.DisplayName = Root.ChildText(TEXT("display_name"));
+	OutClass.Nodes.Reset();
+	if(auto Nodes = Root.FindChild(TEXT("nodes")))
+	{
+		for(auto const& Elem : Nodes->Children)
+		{
+			if(Elem.Name == TEXT("node"))
+			{
+				FDocGenNodeRef Node;
+				Node.Id = Elem.ChildText(TEXT("id"));
+				Node.ShortTitle = Elem.ChildText(TEXT("shorttitle"));
+				OutClass.Nodes.Add(MoveTemp(Node));
+			}
+		}
+	}
+
+	return true;
+}
+
+bool FIntermediateDocReader::ReadNode(FString const& Path, FDocGenNodeContent& OutNode)
+{
+	FDocXmlElement Root;
+	if(!LoadDocXml(Path, Root))
+	{
+		return false;
+	}
+
+	OutNode.DocsName = Root.ChildText(TEXT("docs_name"));
+	OutNode.ClassId = Root.ChildText(TEXT("class_id"));
+	OutNode.ClassName = Root.ChildText(TEXT("class_name"));
+	OutNode.ShortTitle = Root.ChildText(TEXT("shorttitle"));
+	OutNode.FullTitle = Root.ChildText(TEXT("fulltitle"));
+	OutNode.Description = Root.ChildText(TEXT("description"));
+	OutNode.ImgPath = Root.ChildText(TEXT("imgpath"));
+	OutNode.Category = Root.ChildText(TEXT("category"));
+	OutNode.Inputs.Reset();
+	OutNode.Outputs.Reset();
+	ReadParams(Root.FindChild(TEXT("inputs")), OutNode.Inputs);
+	ReadParams(Root.FindChild(TEXT("outputs")), OutNode.Outputs);
+
+	// Node files don't contain their own id, it's implied by the file name
+	OutNode.Id = FPaths::GetBaseFilename(Path);
+
+	return true;
+}
+
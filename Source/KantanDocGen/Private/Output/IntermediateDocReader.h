@@ -0,0 +1,24 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Copyright (C) 2016-2017 Cameron Angus. All Rights Reserved.
+
+#pragma once
+
+#include "DocGenContent.h"
+
+
+/*
+Reads intermediate xml doc files back into plain content.
+Only the subset of xml which the doc generator emits is supported (elements without attributes, text and CDATA sections),
+but unlike FXmlFile, text content is preserved exactly, including newlines.
+*/
+class FIntermediateDocReader
+{
+public:
+	static bool ReadIndex(FString const& Path, FDocGenIndexContent& OutIndex);
+	static bool ReadClass(FString const& Path, FDocGenClassContent& OutClass);
+	static bool ReadNode(FString const& Path, FDocGenNodeContent& OutNode);
+};
+
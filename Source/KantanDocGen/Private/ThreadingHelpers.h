@@ -36,5 +36,74 @@ namespace DocGenThreads
 		return Result;
 	}
 
+	/*
+	Bounded window of tasks dispatched to task graph worker threads.
+	Dispatching while the window is full blocks the caller until the oldest task has completed, which gives
+	producers backpressure against slower consumer stages.
+	*/
+	class FBoundedTaskWindow
+	{
+	public:
+		explicit FBoundedTaskWindow(int32 InMaxInFlight):
+			MaxInFlight(FMath::Max(InMaxInFlight, 1))
+		{}
+
+		~FBoundedTaskWindow()
+		{
+			Drain();
+		}
+
+	public:
+		/** Blocks until at least Count more tasks could be dispatched without exceeding the window. */
+		void WaitForCapacity(int32 Count = 1)
+		{
+			Count = FMath::Clamp(Count, 1, MaxInFlight);
+			while(InFlight.Num() + Count > MaxInFlight)
+			{
+				Prune();
+				if(InFlight.Num() + Count > MaxInFlight)
+				{
+					FTaskGraphInterface::Get().WaitUntilTaskCompletes(InFlight[0]);
+				}
+			}
+		}
+
+		template < typename TLambda >
+		void Dispatch(TLambda Func)
+		{
+			WaitForCapacity();
+
+			InFlight.Add(FFunctionGraphTask::CreateAndDispatchWhenReady(MoveTemp(Func), TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask));
+		}
+
+		/** Blocks until every dispatched task has completed. */
+		void Drain()
+		{
+			if(InFlight.Num() > 0)
+			{
+				FTaskGraphInterface::Get().WaitUntilTasksComplete(InFlight);
+				InFlight.Reset();
+			}
+		}
+
+		int32 Num() const
+		{
+			return InFlight.Num();
+		}
+
+	protected:
+		void Prune()
+		{
+			InFlight.RemoveAll([](FGraphEventRef const& Task)
+			{
+				return Task->IsComplete();
+			});
+		}
+
+	protected:
+		FGraphEventArray InFlight;
+		int32 MaxInFlight;
+	};
+
 }
 